@@ -0,0 +1,147 @@
+// LIS3DH_Mock.c
+// Host model of the LIS3DH accelerometer
+
+#include <string.h>
+#include "LIS3DH_Mock.h"
+
+#define REG_WHO_AM_I    0x0F
+#define REG_CTRL_REG1   0x20
+#define REG_CTRL_REG5   0x24
+#define REG_OUT_X_L     0x28
+#define REG_OUT_Z_H     0x2D
+#define REG_FIFO_CTRL   0x2E
+#define REG_FIFO_SRC    0x2F
+
+#define FIFO_EN         0x40
+#define FM_BYPASS       0
+#define FM_FIFO         1
+#define FM_STREAM       2
+
+#define CTRL_REG1_LPEN  0x08
+
+// Output data rates for ODR = 0..9 in normal/high-resolution and low-power
+// mode; ODR = 8 only exists in low-power mode.
+static const uint16_t odrHz[10] = { 0, 1, 10, 25, 50, 100, 200, 400, 0, 1344 };
+static const uint16_t odrHzLowPower[10] = { 0, 1, 10, 25, 50, 100, 200, 400, 1620, 5376 };
+
+static int fifoMode(const lis3dhMock *m)
+{
+    return (m->regs[REG_CTRL_REG5] & FIFO_EN) ? m->regs[REG_FIFO_CTRL] >> 6 : FM_BYPASS;
+}
+
+static uint64_t periodNs(const lis3dhMock *m)
+{
+    uint8_t odr = m->regs[REG_CTRL_REG1] >> 4;
+    const uint16_t *hz = (m->regs[REG_CTRL_REG1] & CTRL_REG1_LPEN) ? odrHzLowPower : odrHz;
+    if (odr >= sizeof(odrHz) / sizeof(odrHz[0]) || hz[odr] == 0) return 0;
+    return 1000000000ULL / hz[odr];
+}
+
+void lis3dhMockSample(uint32_t n, int16_t xyz[3])
+{
+    // 12-bit left-justified values, distinct per axis and per sample
+    xyz[0] = (int16_t) ((n & 0xFFF) << 4);
+    xyz[1] = (int16_t) (((n * 7 + 1) & 0xFFF) << 4);
+    xyz[2] = (int16_t) ((~n & 0xFFF) << 4);
+}
+
+void lis3dhMockInit(lis3dhMock *mock)
+{
+    memset(mock, 0, sizeof(*mock));
+    mock->regs[REG_WHO_AM_I] = 0x33;
+    mock->regs[REG_CTRL_REG1] = 0x07;
+}
+
+static void produce(lis3dhMock *m)
+{
+    int16_t xyz[3];
+    int mode = fifoMode(m);
+
+    lis3dhMockSample(m->generated++, xyz);
+    memcpy(m->out, xyz, sizeof(xyz));
+    if (mode == FM_BYPASS) return;
+
+    if (m->fifoCount == LIS3DH_MOCK_FIFO_DEPTH) {
+        m->lost++;
+        if (mode == FM_FIFO) return; // FIFO mode stops collecting when full
+        m->fifoHead = (m->fifoHead + 1) % LIS3DH_MOCK_FIFO_DEPTH; // Stream mode discards the oldest
+        m->fifoCount--;
+    }
+    memcpy(m->fifo[(m->fifoHead + m->fifoCount) % LIS3DH_MOCK_FIFO_DEPTH], xyz, sizeof(xyz));
+    m->fifoCount++;
+}
+
+void lis3dhMockAdvance(lis3dhMock *mock, uint32_t ns)
+{
+    uint64_t period = periodNs(mock);
+
+    mock->nowNs += ns;
+    if (!period) {
+        mock->nextSampleNs = mock->nowNs;
+        return;
+    }
+    while (mock->nextSampleNs + period <= mock->nowNs) {
+        mock->nextSampleNs += period;
+        produce(mock);
+    }
+}
+
+static uint8_t readReg(lis3dhMock *m, uint8_t reg)
+{
+    if (reg == REG_FIFO_SRC) {
+        uint8_t fth = m->regs[REG_FIFO_CTRL] & 0x1F;
+        return (fth && m->fifoCount >= fth ? 0x80 : 0)
+             | (m->fifoCount == LIS3DH_MOCK_FIFO_DEPTH ? 0x40 : 0)
+             | (m->fifoCount == 0 ? 0x20 : 0)
+             | (m->fifoCount & 0x1F);
+    }
+    if (reg >= REG_OUT_X_L && reg <= REG_OUT_Z_H) {
+        const int16_t *s = (fifoMode(m) != FM_BYPASS && m->fifoCount) ? m->fifo[m->fifoHead] : m->out;
+        uint16_t v = (uint16_t) s[(reg - REG_OUT_X_L) / 2];
+        uint8_t b = (reg & 1) ? (uint8_t) (v >> 8) : (uint8_t) v;
+
+        // The FIFO advances once the whole sample has been read.
+        if (reg == REG_OUT_Z_H && fifoMode(m) != FM_BYPASS && m->fifoCount) {
+            m->fifoHead = (m->fifoHead + 1) % LIS3DH_MOCK_FIFO_DEPTH;
+            m->fifoCount--;
+            m->delivered++;
+        }
+        return b;
+    }
+    return m->regs[reg & 0x3F];
+}
+
+static void writeReg(lis3dhMock *m, uint8_t reg, uint8_t value)
+{
+    if (reg == REG_WHO_AM_I || reg == REG_FIFO_SRC || (reg >= REG_OUT_X_L && reg <= REG_OUT_Z_H))
+        return; // Read-only
+    m->regs[reg & 0x3F] = value;
+    if (reg == REG_FIFO_CTRL && (value >> 6) == FM_BYPASS) {
+        m->fifoHead = 0; // Bypass mode resets the FIFO
+        m->fifoCount = 0;
+    }
+}
+
+uint8_t lis3dhMockSpi(void *ctx, uint8_t mosi, int first)
+{
+    lis3dhMock *m = (lis3dhMock *) ctx;
+    uint8_t reg, miso = 0;
+
+    if (first) {
+        m->reading = (mosi & 0x80) != 0;
+        m->autoInc = (mosi & 0x40) != 0;
+        m->addr = mosi & 0x3F;
+        return 0xFF;
+    }
+
+    reg = m->addr;
+    if (m->reading) miso = readReg(m, reg);
+    else writeReg(m, reg, mosi);
+
+    if (m->autoInc) {
+        // With the FIFO enabled, reads wrap from OUT_Z_H back to OUT_X_L.
+        if (reg == REG_OUT_Z_H && fifoMode(m) != FM_BYPASS) m->addr = REG_OUT_X_L;
+        else m->addr = (reg + 1) & 0x3F;
+    }
+    return miso;
+}
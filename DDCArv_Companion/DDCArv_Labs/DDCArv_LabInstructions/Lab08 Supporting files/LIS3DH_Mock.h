@@ -0,0 +1,48 @@
+// LIS3DH_Mock.h
+// Host model of the LIS3DH accelerometer for the SPI emulation in REDV_SPI_Host.h
+//
+// Models the register file, the SPI read/write and auto-increment protocol,
+// and the 32-level FIFO in bypass, FIFO and stream modes. Samples are
+// generated at the programmed output data rate as simulated time is advanced
+// with lis3dhMockAdvance(). Sample n always has the values given by
+// lis3dhMockSample(n), so a reader can check that nothing was skipped.
+
+
+#ifndef LIS3DH_MOCK_H
+#define LIS3DH_MOCK_H
+
+#include <stdint.h>
+
+#define LIS3DH_MOCK_FIFO_DEPTH  32
+
+typedef struct
+{
+    uint8_t     regs[0x40];
+    int16_t     fifo[LIS3DH_MOCK_FIFO_DEPTH][3];
+    uint32_t    fifoHead, fifoCount;
+    int16_t     out[3];             // Output registers when the FIFO is bypassed
+    uint8_t     addr;               // Current SPI transaction state
+    int         reading, autoInc;
+    uint64_t    nowNs, nextSampleNs;
+    uint32_t    generated;          // Samples produced by the sensor
+    uint32_t    delivered;          // Samples popped from the FIFO by reads of OUT_Z_H
+    uint32_t    lost;               // Samples overwritten in stream mode or refused in FIFO mode
+} lis3dhMock;
+
+/* Puts the model in its power-on state.
+ */
+void lis3dhMockInit(lis3dhMock *mock);
+
+/* spiHostDevice callback; attach with spiHostAttach(SPI1, lis3dhMockSpi, mock).
+ */
+uint8_t lis3dhMockSpi(void *ctx, uint8_t mosi, int first);
+
+/* Advances simulated time, producing samples at the current output data rate.
+ */
+void lis3dhMockAdvance(lis3dhMock *mock, uint32_t ns);
+
+/* Returns the X, Y and Z values of the nth sample the model produces.
+ */
+void lis3dhMockSample(uint32_t n, int16_t xyz[3]);
+
+#endif
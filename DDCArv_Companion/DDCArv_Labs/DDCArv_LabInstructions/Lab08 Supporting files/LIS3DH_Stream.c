@@ -0,0 +1,252 @@
+// LIS3DH_Stream.c
+// Continuous LIS3DH acquisition through the sensor's FIFO
+//
+// Acquisition alternates between two SPI transactions: a one-byte read of
+// FIFO_SRC, and (once the watermark is reached) a burst read of every stored
+// sample. With the FIFO enabled the LIS3DH wraps its read address from
+// OUT_Z_H back to OUT_X_L, so n samples come out of one 6n-byte read.
+// FIFO_SRC is only read once enough sample periods have passed for the
+// watermark to have been reached, so the bus stays quiet while the FIFO
+// fills; INT1 is not used.
+// Callbacks run from spiAsyncService() in the main loop, which is also where
+// the double buffer is consumed, so neither needs locking.
+
+#include <stddef.h>
+#include "REDV_SPI_Async.h"
+#include "LIS3DH_Stream.h"
+
+#define CTRL_REG1_XYZ_EN    0x07    // X, Y and Z axes enabled
+#define CTRL_REG4_BDU_HR    0x88    // Block data update, high resolution
+#define CTRL_REG5_FIFO_EN   0x40
+#define FIFO_CTRL_BYPASS    0x00
+#define FIFO_CTRL_STREAM    0x80
+#define FIFO_SRC_OVRN       0x40
+#define FIFO_SRC_FSS        0x1F
+
+#define CLINT_MTIME         (*(volatile uint32_t *) 0x0200BFF8U) // Low word of mtime
+#define MTIME_HZ            32768
+
+#define FILTER_FRAC_BITS    8
+
+enum { ST_STOPPED, ST_IDLE, ST_SRC, ST_BURST };
+
+// Output data rates with LPen = 0, as this driver configures the sensor.
+// 0 (power-down) and 8 (1.62 kHz, low-power mode only) are not usable.
+static const uint16_t odrHz[10] = { 0, 1, 10, 25, 50, 100, 200, 400, 0, 1344 };
+
+static lis3dhStreamConfig cfg;
+static lis3dhStreamStats stats;
+static int state = ST_STOPPED;
+static uint32_t periodQ16;          // Sample period in clock ticks, 16.16 fixed point
+
+static uint8_t srcRx[2];
+static uint8_t burstRx[1 + 6 * LIS3DH_FIFO_DEPTH];
+static uint32_t burstCount;
+static uint32_t burstTime;
+static uint32_t nextCheck;          // Clock time of the next FIFO_SRC read
+
+static uint32_t seq;
+static int32_t filt[3];             // Low-pass state, FILTER_FRAC_BITS fractional bits
+static uint32_t decCount;
+
+static lis3dhFrame blocks[2][LIS3DH_BLOCK_FRAMES];
+static int fillIdx;
+static uint32_t fillCount;
+static int readyIdx = -1;
+
+// Schedules the next FIFO_SRC read for when that many more samples have
+// arrived since time t
+static void checkAfter(uint32_t t, uint32_t samples)
+{
+    nextCheck = t + (uint32_t) (((uint64_t) samples * periodQ16) >> 16);
+}
+
+static uint32_t defaultClock(void)
+{
+#ifdef REDV_SPI_HOST
+    return 0;
+#else
+    return CLINT_MTIME;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Double buffer
+///////////////////////////////////////////////////////////////////////////////
+
+static void publishIfFull(void)
+{
+    if (fillCount == LIS3DH_BLOCK_FRAMES && readyIdx < 0) {
+        readyIdx = fillIdx;
+        fillIdx ^= 1;
+        fillCount = 0;
+    }
+}
+
+static void pushFrame(const lis3dhFrame *frame)
+{
+    publishIfFull();
+    if (fillCount == LIS3DH_BLOCK_FRAMES) {
+        stats.dropped++; // Consumer still holds the other half
+        return;
+    }
+    blocks[fillIdx][fillCount++] = *frame;
+    stats.frames++;
+    publishIfFull();
+}
+
+const lis3dhFrame *lis3dhStreamBlock(uint32_t *count)
+{
+    if (readyIdx < 0) return NULL;
+    *count = LIS3DH_BLOCK_FRAMES;
+    return blocks[readyIdx];
+}
+
+void lis3dhStreamRelease(void)
+{
+    readyIdx = -1;
+    publishIfFull();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Filtering
+///////////////////////////////////////////////////////////////////////////////
+
+static int16_t lowPass(int axis, int16_t x)
+{
+    filt[axis] += (x * (1 << FILTER_FRAC_BITS) - filt[axis]) >> cfg.filterShift;
+    return (int16_t) (filt[axis] >> FILTER_FRAC_BITS);
+}
+
+static void processSample(uint32_t timestamp, int16_t x, int16_t y, int16_t z)
+{
+    lis3dhFrame frame;
+
+    if (cfg.filterShift) {
+        if (seq == 0) {
+            filt[0] = x * (1 << FILTER_FRAC_BITS); // Start the filter at the first sample
+            filt[1] = y * (1 << FILTER_FRAC_BITS);
+            filt[2] = z * (1 << FILTER_FRAC_BITS);
+        }
+        x = lowPass(0, x);
+        y = lowPass(1, y);
+        z = lowPass(2, z);
+    }
+
+    frame.timestamp = timestamp;
+    frame.seq = seq++;
+    frame.x = x;
+    frame.y = y;
+    frame.z = z;
+    stats.samples++;
+
+    if (cfg.decimate > 1 && ++decCount < cfg.decimate) return;
+    decCount = 0;
+    pushFrame(&frame);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SPI callbacks
+///////////////////////////////////////////////////////////////////////////////
+
+static void burstDone(uint8_t *rx, uint16_t len, void *ctx)
+{
+    uint32_t i;
+    (void) len;
+    (void) ctx;
+
+    for (i = 0; i < burstCount; i++) {
+        const uint8_t *s = &rx[1 + 6 * i]; // rx[0] is clocked in during the address byte
+        // The newest sample was taken about when FIFO_SRC was read.
+        uint32_t age = (uint32_t) (((uint64_t) (burstCount - 1 - i) * periodQ16) >> 16);
+        processSample(burstTime - age,
+                      (int16_t) (s[0] | (s[1] << 8)),
+                      (int16_t) (s[2] | (s[3] << 8)),
+                      (int16_t) (s[4] | (s[5] << 8)));
+    }
+    checkAfter(burstTime, cfg.watermark);
+    state = ST_IDLE;
+}
+
+static void srcDone(uint8_t *rx, uint16_t len, void *ctx)
+{
+    uint32_t n;
+    (void) len;
+    (void) ctx;
+
+    burstTime = cfg.clock();
+    if (rx[1] & FIFO_SRC_OVRN) {
+        n = LIS3DH_FIFO_DEPTH;
+        stats.fifoFull++;
+    } else {
+        n = rx[1] & FIFO_SRC_FSS;
+    }
+
+    state = ST_IDLE;
+    if (n >= cfg.watermark
+        && spiQueueRead(LIS3DH_OUT_X_L, burstRx, (uint16_t) (6 * n), burstDone, NULL) == 0) {
+        burstCount = n;
+        stats.bursts++;
+        state = ST_BURST;
+    } else if (n < cfg.watermark) {
+        checkAfter(burstTime, cfg.watermark - n);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// User functions
+///////////////////////////////////////////////////////////////////////////////
+
+int lis3dhStreamInit(const lis3dhStreamConfig *config)
+{
+    if (config->odr >= sizeof(odrHz) / sizeof(odrHz[0]) || odrHz[config->odr] == 0) return -1;
+
+    cfg = *config;
+    if (!cfg.clock) {
+        cfg.clock = defaultClock;
+#ifdef REDV_SPI_HOST
+        cfg.clockHz = 0; // No time source on the host: check FIFO_SRC continuously
+#else
+        cfg.clockHz = MTIME_HZ;
+#endif
+    }
+    if (cfg.watermark < 1) cfg.watermark = 1;
+    if (cfg.watermark > LIS3DH_FIFO_DEPTH - 1) cfg.watermark = LIS3DH_FIFO_DEPTH - 1;
+    periodQ16 = (uint32_t) (((uint64_t) cfg.clockHz << 16) / odrHz[cfg.odr]);
+
+    stats = (lis3dhStreamStats) { 0 };
+    seq = 0;
+    decCount = 0;
+    fillIdx = 0;
+    fillCount = 0;
+    readyIdx = -1;
+    state = ST_STOPPED;
+
+    // Switching through bypass mode empties the FIFO before streaming starts.
+    if (spiQueueWrite(LIS3DH_CTRL_REG1, (uint8_t) (cfg.odr << 4) | CTRL_REG1_XYZ_EN, NULL, NULL)
+        || spiQueueWrite(LIS3DH_CTRL_REG4, CTRL_REG4_BDU_HR, NULL, NULL)
+        || spiQueueWrite(LIS3DH_CTRL_REG5, CTRL_REG5_FIFO_EN, NULL, NULL)
+        || spiQueueWrite(LIS3DH_FIFO_CTRL, FIFO_CTRL_BYPASS, NULL, NULL)
+        || spiQueueWrite(LIS3DH_FIFO_CTRL, FIFO_CTRL_STREAM | cfg.watermark, NULL, NULL))
+        return -1;
+
+    checkAfter(cfg.clock(), cfg.watermark);
+    state = ST_IDLE;
+    return 0;
+}
+
+void lis3dhStreamPoll(void)
+{
+    spiAsyncService();
+    if (state != ST_IDLE) return;
+    if (cfg.clockHz && (int32_t) (cfg.clock() - nextCheck) < 0) return; // FIFO still filling
+    if (spiQueueRead(LIS3DH_FIFO_SRC, srcRx, 1, srcDone, NULL) == 0) {
+        stats.checks++;
+        state = ST_SRC;
+    }
+}
+
+lis3dhStreamStats lis3dhStreamGetStats(void)
+{
+    return stats;
+}
@@ -0,0 +1,108 @@
+// LIS3DH_Stream.h
+// Header for continuous LIS3DH acquisition through the sensor's FIFO
+//
+// The LIS3DH is put in stream mode so its 32-level FIFO keeps collecting
+// samples at the full output data rate. Draining is polled rather than
+// driven by INT1: lis3dhStreamPoll() reads FIFO_SRC over the interrupt-driven
+// SPI driver (REDV_SPI_Async.h) once enough sample periods have passed for
+// the watermark to be reached, then drains every stored sample in a single
+// burst read.
+// Frames are timestamped, optionally low-pass filtered and decimated, and
+// delivered in fixed-size blocks through a double buffer.
+
+
+#ifndef LIS3DH_STREAM_H
+#define LIS3DH_STREAM_H
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Constant Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+// LIS3DH registers
+#define LIS3DH_WHO_AM_I     0x0F
+#define LIS3DH_CTRL_REG1    0x20
+#define LIS3DH_CTRL_REG4    0x23
+#define LIS3DH_CTRL_REG5    0x24
+#define LIS3DH_OUT_X_L      0x28
+#define LIS3DH_FIFO_CTRL    0x2E
+#define LIS3DH_FIFO_SRC     0x2F
+
+#define LIS3DH_FIFO_DEPTH   32
+
+// CTRL_REG1 output data rate field (normal / high-resolution mode)
+#define LIS3DH_ODR_1HZ      0x1
+#define LIS3DH_ODR_10HZ     0x2
+#define LIS3DH_ODR_25HZ     0x3
+#define LIS3DH_ODR_50HZ     0x4
+#define LIS3DH_ODR_100HZ    0x5
+#define LIS3DH_ODR_200HZ    0x6
+#define LIS3DH_ODR_400HZ    0x7
+#define LIS3DH_ODR_1344HZ   0x9
+
+#define LIS3DH_BLOCK_FRAMES 64      // Frames per double-buffer half
+
+///////////////////////////////////////////////////////////////////////////////
+// Types
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    uint32_t    timestamp;      // Estimated sample time in clock ticks
+    uint32_t    seq;            // Index of the (pre-decimation) sample since start
+    int16_t     x, y, z;        // Left-justified acceleration, as read from OUT_x
+} lis3dhFrame;
+
+typedef struct
+{
+    uint8_t     odr;            // LIS3DH_ODR_xxx; others are rejected
+    uint8_t     watermark;      // FIFO samples to collect before draining (1 to 31)
+    uint8_t     filterShift;    // Low-pass y += (x - y) >> filterShift; 0 disables
+    uint8_t     decimate;       // Deliver one frame per this many samples; 0 or 1 disables
+    uint32_t    clockHz;        // Rate of clock(); used to time FIFO_SRC reads and back-date
+                                // samples in a burst. 0 reads FIFO_SRC whenever the bus is free
+    uint32_t    (*clock)(void); // Time source. NULL uses the CLINT mtime (32768 Hz)
+} lis3dhStreamConfig;
+
+typedef struct
+{
+    uint32_t    samples;        // Samples read from the FIFO
+    uint32_t    frames;         // Frames delivered after decimation
+    uint32_t    checks;         // FIFO_SRC reads issued
+    uint32_t    bursts;         // Burst reads issued
+    uint32_t    fifoFull;       // Drains that found the FIFO full (data may have been overwritten)
+    uint32_t    dropped;        // Frames discarded because both buffers were full
+} lis3dhStreamStats;
+
+///////////////////////////////////////////////////////////////////////////////
+// LIS3DH Stream User Functions
+///////////////////////////////////////////////////////////////////////////////
+
+/* Queues the register writes that enable the FIFO in stream mode.
+ * spiAsyncInit() must have been called first.
+ *    -- return: 0 on success, -1 if config->odr is not one of the
+ *       LIS3DH_ODR_xxx rates or the SPI queue is full
+ */
+int lis3dhStreamInit(const lis3dhStreamConfig *config);
+
+/* Advances acquisition. Call often from the main loop; it services the SPI
+ * driver and, when the watermark should have been reached, reads FIFO_SRC
+ * to start the next burst.
+ */
+void lis3dhStreamPoll(void);
+
+/* Returns the oldest full block of frames, or NULL if none is ready.
+ *    -- count: set to the number of frames in the block
+ */
+const lis3dhFrame *lis3dhStreamBlock(uint32_t *count);
+
+/* Hands the block returned by lis3dhStreamBlock() back for refilling.
+ */
+void lis3dhStreamRelease(void);
+
+/* Returns the counters collected since lis3dhStreamInit().
+ */
+lis3dhStreamStats lis3dhStreamGetStats(void);
+
+#endif
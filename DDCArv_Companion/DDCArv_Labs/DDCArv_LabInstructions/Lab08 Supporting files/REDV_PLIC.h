@@ -0,0 +1,84 @@
+// REDV_PLIC.h
+// Header for the FE310 platform-level interrupt controller (PLIC) and the
+// machine-mode CSRs needed to take external interrupts on hart 0.
+
+
+#ifndef REDV_PLIC_H
+#define REDV_PLIC_H
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Constant Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define PLIC_BASE   (0x0C000000U)   // PLIC memory-mapped base address
+
+// FE310-G002 global interrupt IDs
+#define PLIC_ID_UART0   3
+#define PLIC_ID_UART1   4
+#define PLIC_ID_QSPI0   5
+#define PLIC_ID_SPI1    6
+#define PLIC_ID_SPI2    7
+
+#define MSTATUS_MIE     (1U << 3)   // Global machine interrupt enable
+#define MIE_MEIE        (1U << 11)  // Machine external interrupt enable
+#define MCAUSE_MEI      (0x8000000BU) // mcause value for a machine external interrupt
+
+///////////////////////////////////////////////////////////////////////////////
+// PLIC Registers
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    volatile uint32_t   priority[53];   // (PLIC offset 0x000000) Source priorities, index 0 unused
+    volatile uint32_t   Reserved1[971];
+    volatile uint32_t   pending[2];     // (PLIC offset 0x001000) Interrupt pending bits
+    volatile uint32_t   Reserved2[1022];
+    volatile uint32_t   enable[2];      // (PLIC offset 0x002000) Hart 0 M-mode enable bits
+    volatile uint32_t   Reserved3[522238];
+    volatile uint32_t   threshold;      // (PLIC offset 0x200000) Hart 0 M-mode priority threshold
+    volatile uint32_t   claim;          // (PLIC offset 0x200004) Hart 0 M-mode claim/complete
+} PLIC_Regs;
+
+#define PLIC ((PLIC_Regs*) PLIC_BASE)  // Set up pointer to struct of type PLIC_Regs aligned at the PLIC base address
+
+///////////////////////////////////////////////////////////////////////////////
+// PLIC User Functions
+///////////////////////////////////////////////////////////////////////////////
+
+/* Routes interrupt source id to hart 0 with the given priority (1 to 7).
+ */
+static inline void plicEnable(uint32_t id, uint32_t priority)
+{
+    PLIC->priority[id] = priority;
+    PLIC->enable[id >> 5] |= (1U << (id & 31));
+    PLIC->threshold = 0;
+}
+
+/* Claims the highest-priority pending interrupt.
+ *    -- return: the source id, or 0 if nothing is pending
+ */
+static inline uint32_t plicClaim(void)
+{
+    return PLIC->claim;
+}
+
+/* Signals that the handler for source id has finished.
+ */
+static inline void plicComplete(uint32_t id)
+{
+    PLIC->claim = id;
+}
+
+/* Installs handler as the machine trap vector and turns on external interrupts.
+ * The handler must be 4-byte aligned (direct mode).
+ */
+static inline void plicInterruptsOn(void (*handler)(void))
+{
+    __asm__ volatile ("csrw mtvec, %0" :: "r"(handler));
+    __asm__ volatile ("csrs mie, %0" :: "r"(MIE_MEIE));
+    __asm__ volatile ("csrs mstatus, %0" :: "r"(MSTATUS_MIE) : "memory");
+}
+
+#endif
@@ -168,10 +168,17 @@ typedef struct
 // SPI
 ///////////////////////////////////////////////////////////////////////////////
 
-
+#ifdef REDV_SPI_HOST
+// Host builds point the peripherals at plain structs emulated by REDV_SPI_Host.c
+extern SPI spiHostBlock[3];
+#define QSPI0 (&spiHostBlock[0])
+#define SPI1  (&spiHostBlock[1])
+#define SPI2  (&spiHostBlock[2])
+#else
 #define QSPI0 ((SPI*) QSPI0_BASE)  // Set up pointer to struct of type SPI aligned at the base QSPI0 memory-mapped address
 #define SPI1  ((SPI*) SPI1_BASE)  // Set up pointer to struct of type SPI aligned at the base SPI1 memory-mapped address
 #define SPI2  ((SPI*) SPI2_BASE)  // Set up pointer to struct of type SPI aligned at the base SPI2 memory-mapped address
+#endif
 
 ///////////////////////////////////////////////////////////////////////////////
 // SPI User Functions
@@ -0,0 +1,272 @@
+// REDV_SPI_Async.c
+// Interrupt-driven SPI1 transfers on the FE310
+//
+// Ownership of the ring indices:
+//   txHead, txnHead           written by the main loop (spiQueue)
+//   txTail, txnActive, rxHead written by the interrupt
+//   rxTail, txnTail           written by the main loop (spiAsyncService)
+// Each index has exactly one writer, so no locks are needed. Indices run
+// freely and are masked on access.
+//
+// The interrupt only loads bytes belonging to the transaction that owns
+// chip select, and never keeps more than SPI_HW_FIFO_DEPTH bytes in flight,
+// so neither hardware FIFO can overflow. It also refuses to load a byte
+// unless the Rx ring has room for the byte it will clock back in.
+//
+// Build with -DREDV_SPI_HOST to run against the register emulation in
+// REDV_SPI_Host.c instead of the real peripheral.
+
+#include <stddef.h>
+#include "REDV_SPI.h"
+#include "REDV_SPI_Async.h"
+
+#define SPI_RXDATA_EMPTY    (1U << 31)
+
+#define CSMODE_AUTO         0
+#define CSMODE_HOLD         2
+
+#define LIS3DH_READ         0x80    // Address bit 7: read
+#define LIS3DH_AUTOINC      0x40    // Address bit 6: increment address on multi-byte access
+
+///////////////////////////////////////////////////////////////////////////////
+// Register access
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef REDV_SPI_HOST
+#include "REDV_SPI_Host.h"
+#define spiRegTxWrite(spi, b)   spiHostTxWrite((spi), (b))
+#define spiRegRxRead(spi)       spiHostRxRead((spi))
+#define spiRegCsMode(spi, m)    spiHostCsMode((spi), (m))
+#define spiIrqSave()            0U
+#define spiIrqRestore(m)        ((void)(m))
+#else
+#include "REDV_PLIC.h"
+// txdata and rxdata are accessed as whole words: reading rxdata pops the FIFO,
+// so the data and empty flag must come from the same read.
+#define spiRegTxWrite(spi, b)   (*(volatile uint32_t *)&(spi)->txdata = (b))
+#define spiRegRxRead(spi)       (*(volatile uint32_t *)&(spi)->rxdata)
+#define spiRegCsMode(spi, m)    ((spi)->csmode.mode = (m))
+
+static inline uint32_t spiIrqSave(void)
+{
+    uint32_t mstatus;
+    __asm__ volatile ("csrrci %0, mstatus, 8" : "=r"(mstatus) :: "memory");
+    return mstatus;
+}
+
+static inline void spiIrqRestore(uint32_t mstatus)
+{
+    __asm__ volatile ("csrs mstatus, %0" :: "r"(mstatus & MSTATUS_MIE) : "memory");
+}
+#endif
+
+// Keeps the compiler from moving ring element accesses across index updates.
+#define spiBarrier() __asm__ volatile ("" ::: "memory")
+
+///////////////////////////////////////////////////////////////////////////////
+// State
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    uint8_t     *rx;
+    uint16_t    len;
+    spiCallback cb;
+    void        *ctx;
+} spiTxn;
+
+static uint8_t  txRing[SPI_TX_RING_SIZE];
+static uint8_t  rxRing[SPI_RX_RING_SIZE];
+static spiTxn   txnRing[SPI_TXN_RING_SIZE];
+
+static volatile uint32_t txHead, txTail;
+static volatile uint32_t rxHead, rxTail;
+static volatile uint32_t txnHead, txnActive, txnTail;
+
+// Owned by the interrupt
+static uint32_t curLoaded;      // Bytes of the active transaction written to txdata
+static uint32_t curReceived;    // Bytes of the active transaction read from rxdata
+static uint32_t inFlight;       // Bytes in the hardware FIFOs
+static int      curOpen;        // Chip select is held for the active transaction
+
+///////////////////////////////////////////////////////////////////////////////
+// Interrupt side
+///////////////////////////////////////////////////////////////////////////////
+
+void spiAsyncIrqHandler(void)
+{
+    uint32_t word;
+
+    // Drain the Rx FIFO, closing the active transaction when its last byte arrives.
+    while (!((word = spiRegRxRead(SPI1)) & SPI_RXDATA_EMPTY)) {
+        rxRing[rxHead & (SPI_RX_RING_SIZE - 1)] = (uint8_t) word;
+        spiBarrier();
+        rxHead = rxHead + 1;
+        inFlight--;
+        if (++curReceived == txnRing[txnActive & (SPI_TXN_RING_SIZE - 1)].len) {
+            spiRegCsMode(SPI1, CSMODE_AUTO); // Release chip select
+            curOpen = 0;
+            spiBarrier();
+            txnActive = txnActive + 1;
+        }
+    }
+
+    // Start the next transaction once the previous one has fully shifted out.
+    if (!curOpen && txnActive != txnHead) {
+        spiRegCsMode(SPI1, CSMODE_HOLD);
+        curOpen = 1;
+        curLoaded = 0;
+        curReceived = 0;
+    }
+
+    // Refill the Tx FIFO.
+    if (curOpen) {
+        uint32_t len = txnRing[txnActive & (SPI_TXN_RING_SIZE - 1)].len;
+        while (curLoaded < len && inFlight < SPI_HW_FIFO_DEPTH
+               && (rxHead - rxTail) + inFlight < SPI_RX_RING_SIZE) {
+            spiRegTxWrite(SPI1, txRing[txTail & (SPI_TX_RING_SIZE - 1)]);
+            spiBarrier();
+            txTail = txTail + 1;
+            curLoaded++;
+            inFlight++;
+        }
+    }
+
+    // Received bytes drive the engine from here on. The Tx watermark is only
+    // used by spiKick() to restart it when it has gone idle.
+    SPI1->ie.txwm = 0;
+    SPI1->ie.rxwm = (inFlight != 0);
+}
+
+#ifndef REDV_SPI_HOST
+/* Machine trap vector. Dispatches SPI1 interrupts claimed from the PLIC.
+ * Declared weak so a program with its own trap handler can replace it and
+ * call spiAsyncIrqHandler() itself.
+ */
+__attribute__((weak, interrupt("machine"), aligned(4)))
+void spiTrapHandler(void)
+{
+    uint32_t mcause;
+    __asm__ volatile ("csrr %0, mcause" : "=r"(mcause));
+
+    if (mcause == MCAUSE_MEI) {
+        uint32_t id = plicClaim();
+        if (id == PLIC_ID_SPI1) spiAsyncIrqHandler();
+        if (id) plicComplete(id);
+    }
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Main loop side
+///////////////////////////////////////////////////////////////////////////////
+
+/* Raises an interrupt on the next instruction (or the next host step) if the
+ * engine is idle. The Tx watermark is pending whenever the Tx FIFO is empty.
+ * ie is also written by the interrupt, so update it with interrupts off.
+ */
+static void spiKick(void)
+{
+    uint32_t mstatus = spiIrqSave();
+    SPI1->ie.txwm = 1;
+    spiIrqRestore(mstatus);
+}
+
+void spiAsyncInit(void)
+{
+    txHead = txTail = rxHead = rxTail = 0;
+    txnHead = txnActive = txnTail = 0;
+    curLoaded = curReceived = inFlight = 0;
+    curOpen = 0;
+
+    SPI1->csmode.mode = CSMODE_AUTO;
+    SPI1->ie.txwm = 0;
+    SPI1->ie.rxwm = 0;
+    SPI1->txmark.txmark = 1; // Tx watermark pending when the Tx FIFO is empty
+    SPI1->rxmark.rxmark = 0; // Rx watermark pending when any byte has arrived
+
+#ifdef REDV_SPI_HOST
+    spiHostSetIrq(SPI1, spiAsyncIrqHandler);
+#else
+    plicEnable(PLIC_ID_SPI1, 1);
+    plicInterruptsOn(spiTrapHandler);
+#endif
+}
+
+/* Queues a transaction whose first txLen bytes come from tx and whose
+ * remaining bytes are zeros.
+ */
+static int spiEnqueue(const uint8_t *tx, uint32_t txLen, uint8_t *rx, uint32_t len,
+                      spiCallback cb, void *ctx)
+{
+    uint32_t i;
+    spiTxn *txn;
+
+    if (len == 0 || len > SPI_MAX_TXN_LEN) return -1;
+    if (txnHead - txnTail >= SPI_TXN_RING_SIZE) return -1;
+    if (SPI_TX_RING_SIZE - (txHead - txTail) < len) return -1;
+
+    for (i = 0; i < len; i++)
+        txRing[(txHead + i) & (SPI_TX_RING_SIZE - 1)] = i < txLen ? tx[i] : 0;
+
+    txn = &txnRing[txnHead & (SPI_TXN_RING_SIZE - 1)];
+    txn->rx = rx;
+    txn->len = len;
+    txn->cb = cb;
+    txn->ctx = ctx;
+
+    spiBarrier();
+    txHead = txHead + len;
+    txnHead = txnHead + 1;
+    spiKick();
+    return 0;
+}
+
+int spiQueue(const uint8_t *tx, uint8_t *rx, uint16_t len, spiCallback cb, void *ctx)
+{
+    return spiEnqueue(tx, tx ? len : 0, rx, len, cb, ctx);
+}
+
+int spiQueueWrite(uint8_t address, uint8_t value, spiCallback cb, void *ctx)
+{
+    uint8_t tx[2] = { address, value };
+    return spiEnqueue(tx, 2, NULL, 2, cb, ctx);
+}
+
+int spiQueueRead(uint8_t address, uint8_t *rx, uint16_t len, spiCallback cb, void *ctx)
+{
+    uint8_t cmd = address | LIS3DH_READ | (len > 1 ? LIS3DH_AUTOINC : 0);
+
+    if (len == 0) return -1;
+    return spiEnqueue(&cmd, 1, rx, (uint32_t) len + 1, cb, ctx);
+}
+
+int spiAsyncService(void)
+{
+    int done = 0;
+
+    while (txnTail != txnActive) {
+        spiTxn txn = txnRing[txnTail & (SPI_TXN_RING_SIZE - 1)];
+        uint32_t i;
+
+        spiBarrier();
+        if (txn.rx)
+            for (i = 0; i < txn.len; i++)
+                txn.rx[i] = rxRing[(rxTail + i) & (SPI_RX_RING_SIZE - 1)];
+        spiBarrier();
+        rxTail = rxTail + txn.len;
+        txnTail = txnTail + 1; // Free the slot before the callback so it can queue more
+
+        if (txn.cb) txn.cb(txn.rx, txn.len, txn.ctx);
+        done++;
+    }
+
+    // Freeing Rx space may unblock a stalled transaction.
+    if (done && txnActive != txnHead) spiKick();
+    return done;
+}
+
+uint32_t spiAsyncPending(void)
+{
+    return txnHead - txnTail;
+}
@@ -0,0 +1,87 @@
+// REDV_SPI_Async.h
+// Header for interrupt-driven SPI1 transfers on the FE310
+//
+// Transactions are queued from the main loop and shifted out by the SPI1
+// watermark interrupt, so the core is free while bytes are on the wire.
+// Each transaction holds chip select for its whole length. Transmit bytes,
+// receive bytes and transaction descriptors each live in a single-producer/
+// single-consumer ring, so the main loop and the interrupt never need a lock.
+
+
+#ifndef REDV_SPI_ASYNC_H
+#define REDV_SPI_ASYNC_H
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Constant Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define SPI_HW_FIFO_DEPTH   8       // Depth of the SPI1 Tx and Rx FIFOs
+
+// Ring sizes must be powers of two.
+#define SPI_TX_RING_SIZE    256     // Bytes waiting to be transmitted
+#define SPI_RX_RING_SIZE    256     // Bytes received but not yet delivered
+#define SPI_TXN_RING_SIZE   16      // Transactions queued or awaiting delivery
+
+#define SPI_MAX_TXN_LEN     SPI_RX_RING_SIZE  // Longest single transaction (bytes)
+
+///////////////////////////////////////////////////////////////////////////////
+// Types
+///////////////////////////////////////////////////////////////////////////////
+
+/* Called from spiAsyncService() once a transaction has finished.
+ *    -- rx: the buffer passed to spiQueue (NULL if none was given)
+ *    -- len: number of bytes transferred
+ *    -- ctx: the pointer passed to spiQueue
+ */
+typedef void (*spiCallback)(uint8_t *rx, uint16_t len, void *ctx);
+
+///////////////////////////////////////////////////////////////////////////////
+// SPI Async User Functions
+///////////////////////////////////////////////////////////////////////////////
+
+/* Switches SPI1 to interrupt-driven operation. Call spiInit() first to set
+ * up the pins, clock and frame format. Enables the SPI1 source in the PLIC
+ * and installs spiTrapHandler as the machine trap vector.
+ */
+void spiAsyncInit(void);
+
+/* Queues a full-duplex transaction. The transmit bytes are copied, so tx may
+ * be reused as soon as this returns; rx must stay valid until the callback.
+ *    -- tx: bytes to send, or NULL to send zeros
+ *    -- rx: where to store received bytes, or NULL to discard them
+ *    -- len: 1 to SPI_MAX_TXN_LEN
+ *    -- cb: completion callback, or NULL
+ *    -- ctx: passed through to cb
+ *    -- return: 0 on success, -1 if the queue is full or len is out of range
+ */
+int spiQueue(const uint8_t *tx, uint8_t *rx, uint16_t len, spiCallback cb, void *ctx);
+
+/* Queues a LIS3DH-style register write (address byte then value).
+ */
+int spiQueueWrite(uint8_t address, uint8_t value, spiCallback cb, void *ctx);
+
+/* Queues a LIS3DH-style register read of len bytes starting at address,
+ * using auto-increment for multi-byte reads. rx receives len + 1 bytes;
+ * rx[0] is the dummy byte clocked in during the address phase.
+ */
+int spiQueueRead(uint8_t address, uint8_t *rx, uint16_t len, spiCallback cb, void *ctx);
+
+/* Copies out finished transactions and runs their callbacks. Call from the
+ * main loop; callbacks may queue further transactions.
+ *    -- return: the number of transactions completed
+ */
+int spiAsyncService(void);
+
+/* Returns the number of transactions queued, in flight, or awaiting
+ * spiAsyncService().
+ */
+uint32_t spiAsyncPending(void);
+
+/* SPI1 interrupt service routine. Called by spiTrapHandler, or by the host
+ * emulation in REDV_SPI_Host.c.
+ */
+void spiAsyncIrqHandler(void);
+
+#endif
@@ -0,0 +1,153 @@
+// REDV_SPI_Host.c
+// Host stand-in for the FE310 SPI register block
+
+#include <string.h>
+#include "REDV_SPI_Host.h"
+
+#define HOST_FIFO_DEPTH     8
+#define HOST_MAX_IRQ_LOOPS  64      // Guards against a handler that never clears its cause
+
+#define CSMODE_HOLD         2
+
+typedef struct
+{
+    uint8_t         tx[HOST_FIFO_DEPTH];
+    uint8_t         rx[HOST_FIFO_DEPTH];
+    uint32_t        txHead, txCount;
+    uint32_t        rxHead, rxCount;
+    int             selected;       // Chip select currently asserted
+    spiHostDevice   device;
+    void            *ctx;
+    void            (*handler)(void);
+    int             inHandler;
+    spiHostStats    stats;
+} spiHostState;
+
+SPI spiHostBlock[3];
+static spiHostState hostState[3];
+
+static spiHostState *stateOf(SPI *spi)
+{
+    return &hostState[spi - spiHostBlock];
+}
+
+/* Recomputes the watermark pending bits. Tx is pending while the FIFO holds
+ * fewer than txmark entries, Rx while it holds more than rxmark.
+ */
+static void updatePending(SPI *spi, spiHostState *st)
+{
+    spi->ip.txwm = st->txCount < spi->txmark.txmark;
+    spi->ip.rxwm = st->rxCount > spi->rxmark.rxmark;
+}
+
+static void deliverIrq(SPI *spi, spiHostState *st)
+{
+    int loops;
+
+    if (!st->handler || st->inHandler) return;
+    st->inHandler = 1;
+    for (loops = 0; loops < HOST_MAX_IRQ_LOOPS; loops++) {
+        updatePending(spi, st);
+        if (!((spi->ip.txwm && spi->ie.txwm) || (spi->ip.rxwm && spi->ie.rxwm))) break;
+        st->stats.interrupts++;
+        st->handler();
+    }
+    st->inHandler = 0;
+}
+
+void spiHostReset(void)
+{
+    int i;
+
+    memset(spiHostBlock, 0, sizeof(spiHostBlock));
+    memset(hostState, 0, sizeof(hostState));
+    for (i = 0; i < 3; i++) {
+        spiHostBlock[i].csdef.csdef = 0xFFFFFFFF; // Reset value per the FE310 manual
+        updatePending(&spiHostBlock[i], &hostState[i]);
+    }
+}
+
+void spiHostAttach(SPI *spi, spiHostDevice device, void *ctx)
+{
+    spiHostState *st = stateOf(spi);
+    st->device = device;
+    st->ctx = ctx;
+}
+
+void spiHostSetIrq(SPI *spi, void (*handler)(void))
+{
+    stateOf(spi)->handler = handler;
+}
+
+uint32_t spiHostStep(SPI *spi, uint32_t frames)
+{
+    spiHostState *st = stateOf(spi);
+    uint32_t shifted = 0;
+
+    deliverIrq(spi, st);
+    while (shifted < frames && st->txCount) {
+        uint8_t mosi = st->tx[st->txHead];
+        uint8_t miso;
+        int first = !st->selected;
+
+        st->txHead = (st->txHead + 1) % HOST_FIFO_DEPTH;
+        st->txCount--;
+
+        if (first) {
+            st->selected = 1;
+            st->stats.selects++;
+        }
+        miso = st->device ? st->device(st->ctx, mosi, first) : 0xFF;
+        if (spi->csmode.mode != CSMODE_HOLD) st->selected = 0; // AUTO: deassert after each frame
+
+        if (st->rxCount < HOST_FIFO_DEPTH) {
+            st->rx[(st->rxHead + st->rxCount) % HOST_FIFO_DEPTH] = miso;
+            st->rxCount++;
+        } else {
+            st->stats.rxOverruns++;
+        }
+        st->stats.frames++;
+        shifted++;
+
+        deliverIrq(spi, st);
+    }
+    updatePending(spi, st);
+    return shifted;
+}
+
+spiHostStats spiHostGetStats(SPI *spi)
+{
+    return stateOf(spi)->stats;
+}
+
+void spiHostTxWrite(SPI *spi, uint8_t data)
+{
+    spiHostState *st = stateOf(spi);
+
+    if (st->txCount < HOST_FIFO_DEPTH) {
+        st->tx[(st->txHead + st->txCount) % HOST_FIFO_DEPTH] = data;
+        st->txCount++;
+    } else {
+        st->stats.txOverruns++;
+    }
+    updatePending(spi, st);
+}
+
+uint32_t spiHostRxRead(SPI *spi)
+{
+    spiHostState *st = stateOf(spi);
+    uint32_t word;
+
+    if (!st->rxCount) return 1U << 31; // empty flag
+    word = st->rx[st->rxHead];
+    st->rxHead = (st->rxHead + 1) % HOST_FIFO_DEPTH;
+    st->rxCount--;
+    updatePending(spi, st);
+    return word;
+}
+
+void spiHostCsMode(SPI *spi, uint32_t mode)
+{
+    spi->csmode.mode = mode;
+    if (mode != CSMODE_HOLD && !stateOf(spi)->txCount) stateOf(spi)->selected = 0;
+}
@@ -0,0 +1,62 @@
+// REDV_SPI_Host.h
+// Host stand-in for the FE310 SPI register block
+//
+// Build with -DREDV_SPI_HOST and link REDV_SPI_Host.c to run SPI code on a
+// PC. QSPI0, SPI1 and SPI2 then point at plain structs. The emulation keeps
+// 8-deep Tx/Rx FIFOs behind txdata/rxdata, updates the ip watermark bits from
+// txmark/rxmark, and calls the registered interrupt handler whenever an
+// enabled watermark is pending. Time only passes in spiHostStep(), which
+// shifts frames through an attached device model.
+
+
+#ifndef REDV_SPI_HOST_H
+#define REDV_SPI_HOST_H
+
+#include <stdint.h>
+#include "REDV_SPI.h"
+
+/* Device model on the far end of the bus. Called once per frame.
+ *    -- ctx: the pointer passed to spiHostAttach
+ *    -- mosi: the byte the controller shifted out
+ *    -- first: 1 if this is the first frame since chip select was asserted
+ *    -- return: the byte the device shifts back on MISO
+ */
+typedef uint8_t (*spiHostDevice)(void *ctx, uint8_t mosi, int first);
+
+typedef struct
+{
+    uint32_t    frames;         // Frames shifted
+    uint32_t    selects;        // Chip select assertions
+    uint32_t    interrupts;     // Interrupt handler calls
+    uint32_t    txOverruns;     // Writes to txdata while the Tx FIFO was full
+    uint32_t    rxOverruns;     // Frames dropped because the Rx FIFO was full
+} spiHostStats;
+
+/* Clears all three register blocks, FIFOs, devices and statistics.
+ */
+void spiHostReset(void);
+
+/* Connects a device model to spi.
+ */
+void spiHostAttach(SPI *spi, spiHostDevice device, void *ctx);
+
+/* Registers the handler called when one of spi's enabled watermarks is pending.
+ */
+void spiHostSetIrq(SPI *spi, void (*handler)(void));
+
+/* Shifts up to frames bytes from the Tx FIFO through the device, delivering
+ * interrupts before the first frame and after each one.
+ *    -- return: the number of frames actually shifted
+ */
+uint32_t spiHostStep(SPI *spi, uint32_t frames);
+
+/* Returns the statistics collected for spi since the last reset.
+ */
+spiHostStats spiHostGetStats(SPI *spi);
+
+// Register side effects used by drivers built with -DREDV_SPI_HOST
+void spiHostTxWrite(SPI *spi, uint8_t data);
+uint32_t spiHostRxRead(SPI *spi);
+void spiHostCsMode(SPI *spi, uint32_t mode);
+
+#endif
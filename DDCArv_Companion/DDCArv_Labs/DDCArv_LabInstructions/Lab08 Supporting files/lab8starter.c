@@ -6,6 +6,11 @@
 #include "EasyREDVIO_ThingPlus.h"
 #include "REDV_SPI.h"
 
+#ifdef STREAM_MODE
+#include "REDV_SPI_Async.h"
+#include "LIS3DH_Stream.h"
+#endif
+
 #define GPIO_IOF0 2
 
 /* Enables the SPI peripheral and intializes its clock speed (baud rate), polarity, and phase.
@@ -107,6 +112,28 @@ int main(void)
 
     // Check WHO_AM_I register. should return 0x33    
     debug = spiRead(0x0F);
+
+#ifdef STREAM_MODE
+    // Stream every sample at 1344 Hz through the LIS3DH FIFO instead of polling.
+    // Build with -DSTREAM_MODE and add REDV_SPI_Async.c and LIS3DH_Stream.c.
+    lis3dhStreamConfig config = { LIS3DH_ODR_1344HZ, 24, 0, 1, 0, 0 };
+    const lis3dhFrame *frames;
+    uint32_t count;
+
+    spiAsyncInit();
+    lis3dhStreamInit(&config);
+
+    while(1)
+    {
+        lis3dhStreamPoll();
+        if ((frames = lis3dhStreamBlock(&count)) != 0)
+        {
+            x = frames[count - 1].x;
+            y = frames[count - 1].y;
+            lis3dhStreamRelease();
+        }
+    }
+#endif
     
     while(1)
     {
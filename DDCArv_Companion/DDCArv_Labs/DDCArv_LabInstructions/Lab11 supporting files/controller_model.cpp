@@ -0,0 +1,160 @@
+// controller_model.cpp
+// C++ reference model of the RISC-V multicycle controller
+
+#include "controller_model.h"
+
+namespace multicycle {
+
+namespace {
+
+// Fields of the packed output word
+constexpr int IMMSRC = 14, ALUSRCA = 12, ALUSRCB = 10, RESULTSRC = 8, ADRSRC = 7,
+              ALUCONTROL = 4, IRWRITE = 3, PCWRITE = 2, REGWRITE = 1, MEMWRITE = 0;
+
+// Main FSM outputs for one state
+struct StateOutputs {
+  uint8_t aluSrcA, aluSrcB, resultSrc, adrSrc, aluOp;
+  bool irWrite, pcUpdate, branch, regWrite, memWrite;
+};
+
+StateOutputs stateOutputs(State s) {
+  //                         SrcA  SrcB  Res   Adr ALUOp  IRW    PCUpd  Branch RegW   MemW
+  switch (s) {
+    case State::Fetch:    return {0b00, 0b10, 0b10, 0, 0b00, true,  true,  false, false, false};
+    case State::Decode:   return {0b01, 0b01, 0b00, 0, 0b00, false, false, false, false, false};
+    case State::MemAdr:   return {0b10, 0b01, 0b00, 0, 0b00, false, false, false, false, false};
+    case State::MemRead:  return {0b00, 0b00, 0b00, 1, 0b00, false, false, false, false, false};
+    case State::MemWB:    return {0b00, 0b00, 0b01, 0, 0b00, false, false, false, true,  false};
+    case State::MemWrite: return {0b00, 0b00, 0b00, 1, 0b00, false, false, false, false, true};
+    case State::ExecuteR: return {0b10, 0b00, 0b00, 0, 0b10, false, false, false, false, false};
+    case State::ALUWB:    return {0b00, 0b00, 0b00, 0, 0b00, false, false, false, true,  false};
+    case State::ExecuteI: return {0b10, 0b01, 0b00, 0, 0b10, false, false, false, false, false};
+    case State::JAL:      return {0b01, 0b10, 0b00, 0, 0b00, false, true,  false, false, false};
+    case State::BEQ:      return {0b10, 0b00, 0b00, 0, 0b01, false, false, true,  false, false};
+  }
+  return {};
+}
+
+// Instruction decoder: ImmSrc from op. Returns false when ImmSrc is X.
+bool immSrc(uint8_t op, uint8_t &imm) {
+  switch (op) {
+    case OP_LW:    imm = 0b00; return true;
+    case OP_SW:    imm = 0b01; return true;
+    case OP_BEQ:   imm = 0b10; return true;
+    case OP_ITYPE: imm = 0b00; return true;
+    case OP_JAL:   imm = 0b11; return true;
+    default:       imm = 0;    return false;  // R-type and unsupported ops
+  }
+}
+
+// ALU decoder using the controller.tv encoding:
+// add 010, sub 110, and 000, or 001, slt 111. Returns false when X.
+bool aluControl(uint8_t aluOp, uint8_t op, uint8_t funct3, bool funct7b5, uint8_t &ctl) {
+  bool rtypeSub = funct7b5 && (op & 0x20);
+  ctl = 0;
+  switch (aluOp) {
+    case 0b00: ctl = 0b010; return true;  // add for lw, sw, PC arithmetic
+    case 0b01: ctl = 0b110; return true;  // sub for beq
+    case 0b10:
+      switch (funct3) {
+        case 0b000: ctl = rtypeSub ? 0b110 : 0b010; return true;
+        case 0b010: ctl = 0b111; return true;
+        case 0b110: ctl = 0b001; return true;
+        case 0b111: ctl = 0b000; return true;
+        default:    return false;
+      }
+    default: return false;
+  }
+}
+
+}  // namespace
+
+const char *stateName(State s) {
+  switch (s) {
+    case State::Fetch:    return "Fetch";
+    case State::Decode:   return "Decode";
+    case State::MemAdr:   return "MemAdr";
+    case State::MemRead:  return "MemRead";
+    case State::MemWB:    return "MemWB";
+    case State::MemWrite: return "MemWrite";
+    case State::ExecuteR: return "ExecuteR";
+    case State::ALUWB:    return "ALUWB";
+    case State::ExecuteI: return "ExecuteI";
+    case State::JAL:      return "JAL";
+    case State::BEQ:      return "BEQ";
+  }
+  return "?";
+}
+
+std::string Outputs::toString() const {
+  static const int widths[] = {2, 2, 2, 2, 1, 3, 1, 1, 1, 1};
+  std::string s;
+  int bit = 15;
+  for (int w : widths) {
+    if (!s.empty()) s += '_';
+    for (int i = 0; i < w; i++, bit--) {
+      if (xmask & (1u << bit)) s += 'X';
+      else s += (value & (1u << bit)) ? '1' : '0';
+    }
+  }
+  return s;
+}
+
+Outputs Controller::outputs(const Inputs &in) const {
+  StateOutputs so = stateOutputs(state_);
+  Outputs out;
+  uint8_t imm, ctl;
+
+  if (immSrc(in.op, imm)) out.value |= imm << IMMSRC;
+  else out.xmask |= 3u << IMMSRC;
+
+  if (aluControl(so.aluOp, in.op, in.funct3, in.funct7b5, ctl)) out.value |= ctl << ALUCONTROL;
+  else out.xmask |= 7u << ALUCONTROL;
+
+  bool pcWrite = so.pcUpdate || (so.branch && in.zero);
+  out.value |= so.aluSrcA << ALUSRCA | so.aluSrcB << ALUSRCB | so.resultSrc << RESULTSRC
+             | so.adrSrc << ADRSRC | so.irWrite << IRWRITE | pcWrite << PCWRITE
+             | so.regWrite << REGWRITE | so.memWrite << MEMWRITE;
+  return out;
+}
+
+State Controller::nextState(State s, uint8_t op) {
+  switch (s) {
+    case State::Fetch: return State::Decode;
+    case State::Decode:
+      switch (op) {
+        case OP_LW:
+        case OP_SW:    return State::MemAdr;
+        case OP_RTYPE: return State::ExecuteR;
+        case OP_ITYPE: return State::ExecuteI;
+        case OP_JAL:   return State::JAL;
+        case OP_BEQ:   return State::BEQ;
+        default:       return State::Fetch;  // Unsupported: skip the instruction
+      }
+    case State::MemAdr:   return op == OP_LW ? State::MemRead : State::MemWrite;
+    case State::MemRead:  return State::MemWB;
+    case State::ExecuteR:
+    case State::ExecuteI:
+    case State::JAL:      return State::ALUWB;
+    case State::MemWB:
+    case State::MemWrite:
+    case State::ALUWB:
+    case State::BEQ:      return State::Fetch;
+  }
+  return State::Fetch;
+}
+
+bool Controller::supported(const Inputs &in) {
+  switch (in.op) {
+    case OP_LW: case OP_SW: case OP_BEQ: case OP_JAL:
+      return true;
+    case OP_RTYPE: case OP_ITYPE: {
+      uint8_t ctl;
+      return aluControl(0b10, in.op, in.funct3, in.funct7b5, ctl);
+    }
+    default:
+      return false;
+  }
+}
+
+}  // namespace multicycle
@@ -0,0 +1,91 @@
+// controller_model.h
+// C++ reference model of the RISC-V multicycle controller
+//
+// Mirrors the controller checked by controller_testbench.sv: the main FSM of
+// the multicycle processor plus its instruction and ALU decoders, using the
+// same output ordering and ALUControl encoding as controller.tv.
+// Outputs are packed into the 16-bit word the testbench compares:
+//   {ImmSrc[1:0], ALUSrcA[1:0], ALUSrcB[1:0], ResultSrc[1:0], AdrSrc,
+//    ALUControl[2:0], IRWrite, PCWrite, RegWrite, MemWrite}
+
+#ifndef CONTROLLER_MODEL_H
+#define CONTROLLER_MODEL_H
+
+#include <cstdint>
+#include <string>
+
+namespace multicycle {
+
+enum class State {
+  Fetch, Decode, MemAdr, MemRead, MemWB, MemWrite,
+  ExecuteR, ALUWB, ExecuteI, JAL, BEQ
+};
+
+const char *stateName(State s);
+
+// Opcodes the controller implements
+constexpr uint8_t OP_LW    = 0b0000011;
+constexpr uint8_t OP_SW    = 0b0100011;
+constexpr uint8_t OP_RTYPE = 0b0110011;
+constexpr uint8_t OP_ITYPE = 0b0010011;
+constexpr uint8_t OP_BEQ   = 0b1100011;
+constexpr uint8_t OP_JAL   = 0b1101111;
+
+struct Inputs {
+  uint8_t op = 0;       // 7 bits
+  uint8_t funct3 = 0;   // 3 bits
+  bool funct7b5 = false;
+  bool zero = false;
+};
+
+// A packed output word. Bits set in xmask are don't-care (X), the way
+// an HDL decoder drives 'x for undefined cases.
+struct Outputs {
+  uint16_t value = 0;
+  uint16_t xmask = 0;
+
+  uint8_t immSrc() const     { return (value >> 14) & 3; }
+  uint8_t aluSrcA() const    { return (value >> 12) & 3; }
+  uint8_t aluSrcB() const    { return (value >> 10) & 3; }
+  uint8_t resultSrc() const  { return (value >> 8) & 3; }
+  bool adrSrc() const        { return (value >> 7) & 1; }
+  uint8_t aluControl() const { return (value >> 4) & 7; }
+  bool irWrite() const       { return (value >> 3) & 1; }
+  bool pcWrite() const       { return (value >> 2) & 1; }
+  bool regWrite() const      { return (value >> 1) & 1; }
+  bool memWrite() const      { return value & 1; }
+
+  // True when every bit that is defined in expected matches this word.
+  bool matches(const Outputs &expected) const {
+    uint16_t care = static_cast<uint16_t>(~(xmask | expected.xmask));
+    return ((value ^ expected.value) & care) == 0;
+  }
+
+  // Renders the word as in controller.tv, e.g. "XX_00_10_10_0_010_1_1_0_0".
+  std::string toString() const;
+};
+
+class Controller {
+ public:
+  void reset() { state_ = State::Fetch; }
+  State state() const { return state_; }
+
+  // Combinational outputs for the current state and inputs.
+  Outputs outputs(const Inputs &in) const;
+
+  // Rising clock edge: advance the FSM.
+  void clock(const Inputs &in) { state_ = nextState(state_, in.op); }
+
+  static State nextState(State s, uint8_t op);
+
+  // True if the controller defines every output for this instruction in
+  // every state it passes through (i.e. no X outputs besides ImmSrc).
+  static bool supported(const Inputs &in);
+
+ private:
+  State state_ = State::Fetch;
+};
+
+}  // namespace multicycle
+
+#endif
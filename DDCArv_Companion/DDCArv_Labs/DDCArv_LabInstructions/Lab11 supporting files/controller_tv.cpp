@@ -0,0 +1,231 @@
+// controller_tv.cpp
+// Runs controller.tv-format test vectors against the C++ controller model,
+// and generates exhaustive vector files for controller_testbench.sv.
+//
+// Build:  g++ -std=c++17 -O2 -o controller_tv controller_tv.cpp controller_model.cpp
+// Usage:  controller_tv check controller.tv [more.tv ...]
+//         controller_tv gen exhaustive.tv
+//
+// check applies one vector per simulated clock exactly as the testbench does
+// (reset into Fetch, then inputs, compare, clock edge). X bits in the expected
+// outputs are treated as don't-care.
+// gen runs every opcode/funct3/funct7b5/Zero combination the controller
+// supports through every state it visits, writing the model's outputs as a
+// vector file the SystemVerilog testbench can load with $readmemb.
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "controller_model.h"
+
+using namespace multicycle;
+
+namespace {
+
+constexpr int kVectorBits = 7 + 3 + 1 + 1 + 16;
+
+struct Vector {
+  Inputs in;
+  Outputs expected;
+  int line = 0;
+};
+
+bool parseVectors(const std::string &path, std::vector<Vector> &vectors) {
+  std::ifstream file(path);
+  if (!file) {
+    std::cerr << "cannot open " << path << "\n";
+    return false;
+  }
+
+  std::string text;
+  for (int lineNum = 1; std::getline(file, text); lineNum++) {
+    std::string bits;
+    size_t comment = text.find("//");
+    if (comment != std::string::npos) text.resize(comment);
+    for (char c : text)
+      if (c != '_' && !isspace(static_cast<unsigned char>(c))) bits += c;
+    if (bits.empty()) continue;
+
+    if (bits.size() != kVectorBits) {
+      std::cerr << path << ":" << lineNum << ": expected " << kVectorBits << " bits, found "
+                << bits.size() << "\n";
+      return false;
+    }
+
+    uint32_t in = 0;
+    Vector v;
+    v.line = lineNum;
+    for (int i = 0; i < kVectorBits; i++) {
+      char c = bits[i];
+      bool x = (c == 'x' || c == 'X' || c == 'z' || c == 'Z');
+      if (!x && c != '0' && c != '1') {
+        std::cerr << path << ":" << lineNum << ": bad digit '" << c << "'\n";
+        return false;
+      }
+      if (i < 12) {
+        if (x) {
+          std::cerr << path << ":" << lineNum << ": inputs must not be X\n";
+          return false;
+        }
+        in = (in << 1) | (c == '1');
+      } else {
+        uint16_t bit = static_cast<uint16_t>(1u << (kVectorBits - 1 - i));
+        if (x) v.expected.xmask |= bit;
+        else if (c == '1') v.expected.value |= bit;
+      }
+    }
+    v.in.op = (in >> 5) & 0x7F;
+    v.in.funct3 = (in >> 2) & 7;
+    v.in.funct7b5 = (in >> 1) & 1;
+    v.in.zero = in & 1;
+    vectors.push_back(v);
+  }
+  return true;
+}
+
+void printMismatch(const Outputs &a, const Outputs &e) {
+  struct Field { const char *name; int lsb, width; };
+  static const Field fields[] = {
+    {"ImmSrc", 14, 2}, {"ALUSrcA", 12, 2}, {"ALUSrcB", 10, 2}, {"ResultSrc", 8, 2},
+    {"AdrSrc", 7, 1}, {"ALUControl", 4, 3}, {"IRWrite", 3, 1}, {"PCWrite", 2, 1},
+    {"RegWrite", 1, 1}, {"MemWrite", 0, 1},
+  };
+  for (const Field &f : fields) {
+    Outputs fa, fe;
+    uint16_t mask = static_cast<uint16_t>(((1u << f.width) - 1) << f.lsb);
+    fa.value = a.value & mask;
+    fa.xmask = a.xmask & mask;
+    fe.value = e.value & mask;
+    fe.xmask = e.xmask & mask;
+    if (!fa.matches(fe)) {
+      std::string as = fa.toString(), es = fe.toString();
+      std::printf("   %s differs: %s (%s expected)\n", f.name, as.c_str(), es.c_str());
+    }
+  }
+}
+
+int check(const std::string &path) {
+  std::vector<Vector> vectors;
+  if (!parseVectors(path, vectors)) return -1;
+
+  auto start = std::chrono::steady_clock::now();
+  Controller ctl;
+  ctl.reset();
+  int errors = 0;
+  for (size_t i = 0; i < vectors.size(); i++) {
+    const Vector &v = vectors[i];
+    Outputs actual = ctl.outputs(v.in);
+    if (!actual.matches(v.expected)) {
+      std::printf("Error on vector %zu (line %d, state %s): inputs: op = %02x funct3 = %x "
+                  "funct7b5 = %d; outputs = %s (%s expected)\n",
+                  i, v.line, stateName(ctl.state()), v.in.op, v.in.funct3, v.in.funct7b5,
+                  actual.toString().c_str(), v.expected.toString().c_str());
+      printMismatch(actual, v.expected);
+      errors++;
+    }
+    ctl.clock(v.in);
+  }
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::printf("%s: %zu tests completed with %d errors (%.3f ms)\n", path.c_str(), vectors.size(),
+              errors, secs * 1e3);
+  return errors;
+}
+
+const char *mnemonic(const Inputs &in) {
+  static const char *rtype[8] = {"add", nullptr, "slt", nullptr, nullptr, nullptr, "or", "and"};
+  static const char *itype[8] = {"addi", nullptr, "slti", nullptr, nullptr, nullptr, "ori", "andi"};
+  switch (in.op) {
+    case OP_LW:    return "lw";
+    case OP_SW:    return "sw";
+    case OP_BEQ:   return "beq";
+    case OP_JAL:   return "jal";
+    case OP_RTYPE: return (in.funct3 == 0 && in.funct7b5) ? "sub" : rtype[in.funct3];
+    case OP_ITYPE: return itype[in.funct3];
+  }
+  return "?";
+}
+
+std::string bitString(uint32_t v, int width) {
+  std::string s;
+  for (int i = width - 1; i >= 0; i--) s += ((v >> i) & 1) ? '1' : '0';
+  return s;
+}
+
+int generate(const std::string &path) {
+  static const uint8_t ops[] = {OP_RTYPE, OP_ITYPE, OP_LW, OP_SW, OP_BEQ, OP_JAL};
+  std::ofstream out(path);
+  if (!out) {
+    std::cerr << "cannot write " << path << "\n";
+    return -1;
+  }
+
+  out << "// riscv multi-cycle controller test vectors\n"
+         "// Generated by controller_tv from the C++ controller model.\n"
+         "// Every supported op/funct3/funct7b5/Zero combination, run through every state.\n\n"
+         "//op[6:0]_funct3[2:0]_funct7b5_Zero_ImmSrc[1:0]_ALUSrcA[1:0]_ALUSrcB[1:0]_"
+         "ResultSrc[1:0]_AdrSrc_ALUControl[2:0]_IRWrite_PCWrite_RegWrite_MemWrite\n";
+
+  int count = 0, instructions = 0;
+  Controller ctl;
+  ctl.reset();
+  for (uint8_t op : ops) {
+    for (int funct3 = 0; funct3 < 8; funct3++) {
+      for (int f7 = 0; f7 < 2; f7++) {
+        for (int zero = 0; zero < 2; zero++) {
+          Inputs in;
+          in.op = op;
+          in.funct3 = static_cast<uint8_t>(funct3);
+          in.funct7b5 = f7;
+          in.zero = zero;
+          if (!Controller::supported(in)) continue;
+
+          out << "\n// " << mnemonic(in) << " funct3=" << bitString(in.funct3, 3)
+              << " funct7b5=" << f7 << " Zero=" << zero << "\n";
+          std::string inBits = bitString(in.op, 7) + "_" + bitString(in.funct3, 3) + "_" +
+                               bitString(f7, 1) + "_" + bitString(zero, 1) + "__";
+          do {
+            out << inBits << ctl.outputs(in).toString() << " // " << stateName(ctl.state())
+                << "\n";
+            ctl.clock(in);
+            count++;
+          } while (ctl.state() != State::Fetch);
+          instructions++;
+        }
+      }
+    }
+  }
+
+  std::printf("%s: wrote %d vectors for %d instructions\n", path.c_str(), count, instructions);
+  return 0;
+}
+
+void usage() {
+  std::cerr << "usage: controller_tv check FILE.tv [FILE.tv ...]\n"
+               "       controller_tv gen OUT.tv\n";
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    usage();
+    return 2;
+  }
+  std::string mode = argv[1];
+
+  if (mode == "gen") return generate(argv[2]) ? 1 : 0;
+  if (mode == "check") {
+    int failed = 0;
+    for (int i = 2; i < argc; i++)
+      if (check(argv[i]) != 0) failed = 1;
+    return failed;
+  }
+  usage();
+  return 2;
+}
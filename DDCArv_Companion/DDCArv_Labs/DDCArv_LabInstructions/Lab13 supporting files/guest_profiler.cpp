@@ -0,0 +1,219 @@
+// guest_profiler.cpp
+// Execution profiler for programs running on the RV32I core model
+
+#include "guest_profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+
+namespace rv {
+
+namespace {
+
+constexpr size_t kMaxDepth = 256;  // Deeper calls are attributed to the deepest frame
+
+std::string hexPc(uint32_t pc) {
+  char buf[16];
+  std::snprintf(buf, sizeof(buf), "0x%x", pc);
+  return buf;
+}
+
+double percent(uint64_t part, uint64_t whole) { return whole ? 100.0 * part / whole : 0.0; }
+
+}  // namespace
+
+Mnemonic classify(uint32_t instr) {
+  static const Mnemonic branch[8] = {Mnemonic::BEQ, Mnemonic::BNE, Mnemonic::ILLEGAL,
+                                     Mnemonic::ILLEGAL, Mnemonic::BLT, Mnemonic::BGE,
+                                     Mnemonic::BLTU, Mnemonic::BGEU};
+  static const Mnemonic load[8] = {Mnemonic::LB, Mnemonic::LH, Mnemonic::LW, Mnemonic::ILLEGAL,
+                                   Mnemonic::LBU, Mnemonic::LHU, Mnemonic::ILLEGAL,
+                                   Mnemonic::ILLEGAL};
+  static const Mnemonic store[8] = {Mnemonic::SB, Mnemonic::SH, Mnemonic::SW, Mnemonic::ILLEGAL,
+                                    Mnemonic::ILLEGAL, Mnemonic::ILLEGAL, Mnemonic::ILLEGAL,
+                                    Mnemonic::ILLEGAL};
+  static const Mnemonic imm[8] = {Mnemonic::ADDI, Mnemonic::SLLI, Mnemonic::SLTI, Mnemonic::SLTIU,
+                                  Mnemonic::XORI, Mnemonic::SRLI, Mnemonic::ORI, Mnemonic::ANDI};
+  static const Mnemonic reg[8] = {Mnemonic::ADD, Mnemonic::SLL, Mnemonic::SLT, Mnemonic::SLTU,
+                                  Mnemonic::XOR, Mnemonic::SRL, Mnemonic::OR, Mnemonic::AND};
+
+  const uint32_t funct3 = (instr >> 12) & 7;
+  const bool funct7b5 = (instr >> 30) & 1;
+  switch (instr & 0x7F) {
+    case 0b0110111: return Mnemonic::LUI;
+    case 0b0010111: return Mnemonic::AUIPC;
+    case 0b1101111: return Mnemonic::JAL;
+    case 0b1100111: return Mnemonic::JALR;
+    case 0b1100011: return branch[funct3];
+    case 0b0000011: return load[funct3];
+    case 0b0100011: return store[funct3];
+    case 0b0010011: return (funct3 == 5 && funct7b5) ? Mnemonic::SRAI : imm[funct3];
+    case 0b0110011:
+      if (funct3 == 0 && funct7b5) return Mnemonic::SUB;
+      if (funct3 == 5 && funct7b5) return Mnemonic::SRA;
+      return reg[funct3];
+    case 0b0001111: return Mnemonic::FENCE;
+    case 0b1110011: return ((instr >> 20) & 1) ? Mnemonic::EBREAK : Mnemonic::ECALL;
+    default:        return Mnemonic::ILLEGAL;
+  }
+}
+
+const char *mnemonicName(Mnemonic m) {
+  static const char *names[] = {
+    "lui", "auipc", "jal", "jalr",
+    "beq", "bne", "blt", "bge", "bltu", "bgeu",
+    "lb", "lh", "lw", "lbu", "lhu", "sb", "sh", "sw",
+    "addi", "slti", "sltiu", "xori", "ori", "andi", "slli", "srli", "srai",
+    "add", "sub", "sll", "slt", "sltu", "xor", "srl", "sra", "or", "and",
+    "fence", "ecall", "ebreak", "illegal",
+  };
+  return names[static_cast<size_t>(m)];
+}
+
+GuestProfiler::GuestProfiler(uint32_t entryPc, uint32_t blockBytes, uint32_t memBytes) {
+  blockShift_ = 0;
+  while (blockShift_ < 31 && (1u << blockShift_) < blockBytes) blockShift_++;
+  // The stack starts at the top of memory, so the whole window is touched
+  // early; allocate it up front.
+  blockWindow_ = std::min(memBytes >> blockShift_, maxBlockWindow_);
+  blockDense_.resize(blockWindow_);
+  frames_.push_back(Frame{0, entryPc, {}});
+  stack_.push_back(0);
+}
+
+GuestProfiler::PcCount &GuestProfiler::pcCountSlow(uint32_t pc) {
+  const uint32_t word = pc >> 2;
+  if (word < pcWindow_) {
+    pcDense_.resize(std::max<size_t>(word + 1, pcDense_.size() * 2));
+    return pcDense_[word];
+  }
+  return pcSparse_[pc];
+}
+
+void GuestProfiler::decode(PcCount &p, uint32_t instr) {
+  p.instr = instr;
+  p.mnemonic = classify(instr);
+}
+
+void GuestProfiler::jump(const Retired &r, Mnemonic m) {
+  const uint32_t rd = (r.instr >> 7) & 31;
+  const uint32_t rs1 = (r.instr >> 15) & 31;
+  if (rd == 1 || rd == 5) {  // Call
+    if (stack_.size() < kMaxDepth) stack_.push_back(child(stack_.back(), r.nextPc));
+    else overflow_++;
+  } else if (m == Mnemonic::JALR && rd == 0 && (rs1 == 1 || rs1 == 5) && overflow_) {
+    overflow_--;  // Return from a call too deep to track
+  } else if (m == Mnemonic::JALR && rd == 0 && (rs1 == 1 || rs1 == 5) && stack_.size() > 1) {
+    stack_.pop_back();  // Return
+  }
+}
+
+uint32_t GuestProfiler::child(uint32_t parent, uint32_t entry) {
+  uint64_t key = (uint64_t(parent) << 32) | entry;
+  auto it = children_.find(key);
+  if (it != children_.end()) return it->second;
+  uint32_t id = static_cast<uint32_t>(frames_.size());
+  frames_.push_back(Frame{parent, entry, {}});
+  children_.emplace(key, id);
+  return id;
+}
+
+// All PCs seen, dense then sparse
+std::vector<std::pair<uint32_t, const GuestProfiler::PcCount *>> GuestProfiler::allPcs() const {
+  std::vector<std::pair<uint32_t, const PcCount *>> pcs;
+  for (size_t w = 0; w < pcDense_.size(); w++)
+    if (pcDense_[w].count) pcs.emplace_back(static_cast<uint32_t>(w << 2), &pcDense_[w]);
+  for (const auto &kv : pcSparse_) pcs.emplace_back(kv.first, &kv.second);
+  return pcs;
+}
+
+
+std::array<uint64_t, static_cast<size_t>(Mnemonic::Count)> GuestProfiler::mix() const {
+  std::array<uint64_t, static_cast<size_t>(Mnemonic::Count)> total{};
+  for (const Frame &f : frames_)
+    for (size_t m = 0; m < total.size(); m++) total[m] += f.counts[m];
+  return total;
+}
+
+uint64_t GuestProfiler::instructions() const {
+  uint64_t n = 0;
+  for (uint64_t c : mix()) n += c;
+  return n;
+}
+
+void GuestProfiler::writeMix(std::ostream &out) const {
+  const auto mix_ = mix();
+  const uint64_t instructions_ = instructions();
+  std::vector<size_t> order;
+  for (size_t i = 0; i < mix_.size(); i++)
+    if (mix_[i]) order.push_back(i);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return mix_[a] > mix_[b]; });
+
+  out << "mnemonic,count,percent\n";
+  for (size_t i : order) {
+    char pct[32];
+    std::snprintf(pct, sizeof(pct), "%.2f", percent(mix_[i], instructions_));
+    out << mnemonicName(static_cast<Mnemonic>(i)) << "," << mix_[i] << "," << pct << "\n";
+  }
+}
+
+void GuestProfiler::writeHotPcs(std::ostream &out, size_t top) const {
+  const uint64_t total = instructions();
+  std::vector<std::pair<uint32_t, const PcCount *>> pcs = allPcs();
+  std::sort(pcs.begin(), pcs.end(), [](const auto &a, const auto &b) {
+    return a.second->count != b.second->count ? a.second->count > b.second->count
+                                              : a.first < b.first;
+  });
+  if (top && pcs.size() > top) pcs.resize(top);
+
+  out << "pc,count,percent\n";
+  for (const auto &p : pcs) {
+    char pct[32];
+    std::snprintf(pct, sizeof(pct), "%.2f", percent(p.second->count, total));
+    out << hexPc(p.first) << "," << p.second->count << "," << pct << "\n";
+  }
+}
+
+void GuestProfiler::writeBranches(std::ostream &out) const {
+  std::map<uint32_t, const PcCount *> sorted;
+  for (const auto &p : allPcs())
+    if (p.second->taken || p.second->notTaken) sorted.insert(p);
+  out << "pc,taken,not_taken,taken_percent\n";
+  for (const auto &kv : sorted) {
+    char pct[32];
+    std::snprintf(pct, sizeof(pct), "%.2f",
+                  percent(kv.second->taken, kv.second->taken + kv.second->notTaken));
+    out << hexPc(kv.first) << "," << kv.second->taken << "," << kv.second->notTaken << ","
+        << pct << "\n";
+  }
+}
+
+void GuestProfiler::writeMemory(std::ostream &out) const {
+  std::map<uint32_t, BlockCount> sorted(blockSparse_.begin(), blockSparse_.end());
+  for (size_t i = 0; i < blockDense_.size(); i++)
+    if (blockDense_[i].loads || blockDense_[i].stores)
+      sorted.emplace(static_cast<uint32_t>(i), blockDense_[i]);
+  out << "block,loads,stores\n";
+  for (const auto &kv : sorted)
+    out << hexPc(kv.first << blockShift_) << "," << kv.second.loads << "," << kv.second.stores
+        << "\n";
+}
+
+void GuestProfiler::writeFolded(std::ostream &out) const {
+  for (size_t f = 0; f < frames_.size(); f++) {
+    std::string path;
+    for (uint32_t id = static_cast<uint32_t>(f);; id = frames_[id].parent) {
+      path = hexPc(frames_[id].entry) + (path.empty() ? "" : ";") + path;
+      if (id == 0) break;
+    }
+    const Frame &fr = frames_[f];
+    for (size_t m = 0; m < fr.counts.size(); m++)
+      if (fr.counts[m])
+        out << path << ";" << mnemonicName(static_cast<Mnemonic>(m)) << " " << fr.counts[m]
+            << "\n";
+  }
+}
+
+}  // namespace rv
@@ -0,0 +1,144 @@
+// guest_profiler.h
+// Execution profiler for programs running on the RV32I core model
+//
+// Feed it the Retired record from every Core::step(). It keeps
+//   - an instruction mix by mnemonic
+//   - a hot-PC histogram
+//   - taken/not-taken counts for every conditional branch
+//   - load/store counts per address block (a heatmap of data accesses)
+//   - a shadow call stack built from jal/jalr on ra (x1) or t0 (x5), so
+//     instruction counts can be written as folded stacks for flamegraph.pl
+//     or speedscope.
+// Per-PC counts (with branch outcomes and the decoded mnemonic) for the first
+// 256 KiB of code, and data-block counts inside main memory, live in flat
+// arrays indexed by address. record() is inline and costs two or three array
+// increments per instruction; hash maps are only touched on calls, to find
+// the callee's frame, and for addresses outside those windows.
+
+#ifndef GUEST_PROFILER_H
+#define GUEST_PROFILER_H
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "riscv_model.h"
+
+namespace rv {
+
+enum class Mnemonic : uint8_t {
+  LUI, AUIPC, JAL, JALR,
+  BEQ, BNE, BLT, BGE, BLTU, BGEU,
+  LB, LH, LW, LBU, LHU, SB, SH, SW,
+  ADDI, SLTI, SLTIU, XORI, ORI, ANDI, SLLI, SRLI, SRAI,
+  ADD, SUB, SLL, SLT, SLTU, XOR, SRL, SRA, OR, AND,
+  FENCE, ECALL, EBREAK, ILLEGAL,
+  Count
+};
+
+Mnemonic classify(uint32_t instr);
+const char *mnemonicName(Mnemonic m);
+
+class GuestProfiler {
+ public:
+  // Data accesses are binned into blocks of blockBytes (a power of two);
+  // blocks below memBytes get the flat table.
+  explicit GuestProfiler(uint32_t entryPc = 0, uint32_t blockBytes = 64,
+                         uint32_t memBytes = 1u << 20);
+
+  void record(const Retired &r);
+
+  uint64_t instructions() const;
+
+  // CSV reports
+  void writeMix(std::ostream &out) const;       // mnemonic,count,percent
+  void writeHotPcs(std::ostream &out, size_t top = 0) const;  // pc,count,percent; top 0 = all
+  void writeBranches(std::ostream &out) const;  // pc,taken,not_taken,taken_percent
+  void writeMemory(std::ostream &out) const;    // block,loads,stores
+
+  // Folded stacks: "0x0;0x4c;lw 1234" per line. Frames are function entry
+  // PCs; the leaf is the mnemonic so hot instruction types show up per function.
+  void writeFolded(std::ostream &out) const;
+
+ private:
+  struct Frame {
+    uint32_t parent;
+    uint32_t entry;
+    std::array<uint64_t, static_cast<size_t>(Mnemonic::Count)> counts{};
+  };
+  struct PcCount {
+    uint64_t count = 0;
+    uint64_t taken = 0, notTaken = 0;  // Conditional branches only
+    uint32_t instr = 0;                // Last instruction seen here, and its class
+    Mnemonic mnemonic = Mnemonic::ILLEGAL;
+  };
+  struct BlockCount {
+    uint64_t loads = 0, stores = 0;
+  };
+
+  PcCount &pcCount(uint32_t pc);
+  PcCount &pcCountSlow(uint32_t pc);
+  BlockCount &blockCount(uint32_t addr);
+  static void decode(PcCount &p, uint32_t instr);
+  void jump(const Retired &r, Mnemonic m);  // Call/return tracking for jal and jalr
+  std::vector<std::pair<uint32_t, const PcCount *>> allPcs() const;
+  uint32_t child(uint32_t parent, uint32_t entry);
+
+  // The overall mix and instruction count are summed from the frames when
+  // reports are written, rather than counted again per instruction.
+  std::array<uint64_t, static_cast<size_t>(Mnemonic::Count)> mix() const;
+
+  // Per PC: dense table for the first pcWindow_ words of code, map beyond it.
+  static constexpr uint32_t pcWindow_ = 1u << 16;
+  std::vector<PcCount> pcDense_;
+  std::unordered_map<uint32_t, PcCount> pcSparse_;
+
+  // Data blocks: dense up to blockWindow_ blocks (main memory, capped)
+  static constexpr uint32_t maxBlockWindow_ = 1u << 20;
+  uint32_t blockWindow_ = 0;
+  std::vector<BlockCount> blockDense_;
+  std::unordered_map<uint32_t, BlockCount> blockSparse_;
+  int blockShift_ = 6;
+
+  std::vector<Frame> frames_;                            // Call tree, frames_[0] is the root
+  std::unordered_map<uint64_t, uint32_t> children_;      // (parent << 32 | entry) -> frame
+  std::vector<uint32_t> stack_;                          // Current path, innermost last
+  uint32_t overflow_ = 0;                                // Calls deeper than the stack limit
+};
+
+// The hot path is inline; first visits, sparse addresses and calls go out of line.
+inline GuestProfiler::PcCount &GuestProfiler::pcCount(uint32_t pc) {
+  const uint32_t word = pc >> 2;
+  return word < pcDense_.size() ? pcDense_[word] : pcCountSlow(pc);
+}
+
+inline GuestProfiler::BlockCount &GuestProfiler::blockCount(uint32_t addr) {
+  const uint32_t block = addr >> blockShift_;
+  return block < blockWindow_ ? blockDense_[block] : blockSparse_[block];
+}
+
+inline void GuestProfiler::record(const Retired &r) {
+  PcCount &p = pcCount(r.pc);
+  if (p.instr != r.instr || !p.count) decode(p, r.instr);  // First visit, or rewritten code
+  const Mnemonic m = p.mnemonic;
+
+  p.count++;
+  frames_[stack_.back()].counts[static_cast<size_t>(m)]++;
+
+  if (r.branch) {
+    if (r.taken) p.taken++;
+    else p.notTaken++;
+  } else if (r.load || r.store) {
+    BlockCount &b = blockCount(r.memAddr);
+    if (r.load) b.loads++;
+    else b.stores++;
+  } else if (m == Mnemonic::JAL || m == Mnemonic::JALR) {
+    jump(r, m);
+  }
+}
+
+}  // namespace rv
+
+#endif
@@ -0,0 +1,212 @@
+// memory_hierarchy.cpp
+// Cache and memory-hierarchy model for the RV32I core model
+
+#include "memory_hierarchy.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace rv {
+
+namespace {
+
+bool powerOfTwo(uint32_t v) { return v && !(v & (v - 1)); }
+
+int log2(uint32_t v) {
+  int n = 0;
+  while (v >>= 1) n++;
+  return n;
+}
+
+}  // namespace
+
+CacheConfig parseCacheConfig(const std::string &spec, bool writable) {
+  CacheConfig c;
+  if (spec == "off" || spec == "0") return c;
+
+  std::vector<std::string> f;
+  std::istringstream in(spec);
+  for (std::string part; std::getline(in, part, ':');) f.push_back(part);
+  if (f.size() < 3 || f.size() > (writable ? 5u : 4u))
+    throw std::invalid_argument("cache spec '" + spec + "' is not size:line:ways[:policy" +
+                                (writable ? "[:wb|wt]]" : "]"));
+
+  try {
+    c.sizeBytes = static_cast<uint32_t>(std::stoul(f[0]));
+    c.lineBytes = static_cast<uint32_t>(std::stoul(f[1]));
+    c.ways = static_cast<uint32_t>(std::stoul(f[2]));
+  } catch (const std::exception &) {
+    throw std::invalid_argument("cache spec '" + spec + "' has a non-numeric size");
+  }
+  if (f.size() > 3) {
+    if (f[3] == "lru") c.replacement = Replacement::LRU;
+    else if (f[3] == "fifo") c.replacement = Replacement::FIFO;
+    else if (f[3] == "random") c.replacement = Replacement::Random;
+    else throw std::invalid_argument("unknown replacement policy '" + f[3] + "'");
+  }
+  if (f.size() > 4) {
+    if (f[4] == "wb") c.writePolicy = WritePolicy::WriteBack;
+    else if (f[4] == "wt") c.writePolicy = WritePolicy::WriteThrough;
+    else throw std::invalid_argument("unknown write policy '" + f[4] + "'");
+  }
+  return c;
+}
+
+std::string describe(const CacheConfig &c, bool writable) {
+  if (!c.sizeBytes) return "off";
+  static const char *repl[] = {"LRU", "FIFO", "random"};
+  std::ostringstream s;
+  s << c.sizeBytes << " B, " << c.lineBytes << " B lines, " << c.ways << "-way, "
+    << repl[static_cast<int>(c.replacement)];
+  if (writable) s << ", " << (c.writePolicy == WritePolicy::WriteBack ? "write-back" : "write-through");
+  return s.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Cache
+///////////////////////////////////////////////////////////////////////////////
+
+Cache::Cache(const CacheConfig &config) : config_(config) {
+  if (!enabled()) return;
+  if (!powerOfTwo(config.lineBytes) || config.lineBytes < 4)
+    throw std::invalid_argument("line size must be a power of two of at least 4 bytes");
+  if (!powerOfTwo(config.ways)) throw std::invalid_argument("associativity must be a power of two");
+  if (!powerOfTwo(config.sizeBytes) || config.sizeBytes < config.lineBytes * config.ways)
+    throw std::invalid_argument("cache size must be a power of two holding at least one set");
+
+  sets_ = config.sizeBytes / (config.lineBytes * config.ways);
+  offsetBits_ = log2(config.lineBytes);
+  indexBits_ = log2(sets_);
+  lines_.assign(sets_ * config.ways, Line());
+}
+
+uint32_t Cache::victim(uint32_t set) {
+  Line *way = &lines_[set * config_.ways];
+  for (uint32_t w = 0; w < config_.ways; w++)
+    if (!way[w].valid) return w;
+
+  if (config_.replacement == Replacement::Random) {
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 17;
+    rng_ ^= rng_ << 5;
+    return rng_ & (config_.ways - 1);
+  }
+  // LRU and FIFO both evict the smallest stamp; they differ in when it is updated.
+  uint32_t v = 0;
+  for (uint32_t w = 1; w < config_.ways; w++)
+    if (way[w].stamp < way[v].stamp) v = w;
+  return v;
+}
+
+Cache::Result Cache::access(uint32_t addr, bool write) {
+  Result r;
+  const uint32_t set = (addr >> offsetBits_) & (sets_ - 1);
+  const uint32_t tag = addr >> (offsetBits_ + indexBits_);
+  Line *way = &lines_[set * config_.ways];
+  const bool writeBack = config_.writePolicy == WritePolicy::WriteBack;
+
+  clock_++;
+  if (write) stats_.writes++;
+  else stats_.reads++;
+
+  for (uint32_t w = 0; w < config_.ways; w++) {
+    if (way[w].valid && way[w].tag == tag) {
+      r.hit = true;
+      if (config_.replacement == Replacement::LRU) way[w].stamp = clock_;
+      if (write && writeBack) way[w].dirty = true;
+      return r;
+    }
+  }
+
+  if (write) stats_.writeMisses++;
+  else stats_.readMisses++;
+  if (write && !writeBack) return r;  // No-write-allocate
+
+  Line &v = way[victim(set)];
+  if (v.valid && v.dirty) {
+    r.writeback = true;
+    stats_.writebacks++;
+  }
+  v.valid = true;
+  v.dirty = write && writeBack;
+  v.tag = tag;
+  v.stamp = clock_;
+  r.fill = true;
+  return r;
+}
+
+void Cache::flush() {
+  for (Line &l : lines_) l = Line();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main memory
+///////////////////////////////////////////////////////////////////////////////
+
+MainMemory::MainMemory(uint32_t sizeBytes) : mask_(sizeBytes - 1) {
+  if (!powerOfTwo(sizeBytes)) throw std::invalid_argument("main memory size must be a power of two");
+  bytes_.assign(sizeBytes, 0);
+}
+
+void MainMemory::load(const std::vector<uint8_t> &image, uint32_t base) {
+  if (image.size() > bytes_.size() || base > bytes_.size() - image.size())
+    throw std::out_of_range("program does not fit in main memory");
+  std::copy(image.begin(), image.end(), bytes_.begin() + base);
+}
+
+uint32_t MainMemory::read(uint32_t addr, unsigned bytes) const {
+  uint32_t v = 0;
+  for (unsigned b = 0; b < bytes; b++) v |= uint32_t(bytes_[(addr + b) & mask_]) << (8 * b);
+  return v;
+}
+
+void MainMemory::write(uint32_t addr, unsigned bytes, uint32_t value) {
+  for (unsigned b = 0; b < bytes; b++)
+    bytes_[(addr + b) & mask_] = static_cast<uint8_t>(value >> (8 * b));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Hierarchy
+///////////////////////////////////////////////////////////////////////////////
+
+void MemoryHierarchy::charge(Cache &cache, uint32_t addr, bool write) {
+  const uint32_t lineCycles = timing_.latency + (cache.config().lineBytes / 4) * timing_.cyclesPerWord;
+  const uint32_t wordCycles = timing_.latency + timing_.cyclesPerWord;
+  CacheStats &s = cache.stats();
+
+  if (!cache.enabled()) {  // Every access goes to memory
+    if (write) {
+      s.writes++;
+      s.writeMisses++;
+    } else {
+      s.reads++;
+      s.readMisses++;
+    }
+    s.stallCycles += wordCycles;
+    return;
+  }
+
+  // Accesses are charged to the line holding their first byte.
+  Cache::Result r = cache.access(addr, write);
+  if (r.writeback) s.stallCycles += lineCycles;
+  if (r.fill) s.stallCycles += lineCycles;
+  if (write && cache.config().writePolicy == WritePolicy::WriteThrough) s.stallCycles += wordCycles;
+}
+
+uint32_t MemoryHierarchy::fetch(uint32_t addr) {
+  charge(icache_, addr, false);
+  return memory_.read(addr, 4);
+}
+
+uint32_t MemoryHierarchy::load(uint32_t addr, unsigned bytes) {
+  charge(dcache_, addr, false);
+  return memory_.read(addr, bytes);
+}
+
+void MemoryHierarchy::store(uint32_t addr, unsigned bytes, uint32_t value) {
+  charge(dcache_, addr, true);
+  memory_.write(addr, bytes, value);
+}
+
+}  // namespace rv
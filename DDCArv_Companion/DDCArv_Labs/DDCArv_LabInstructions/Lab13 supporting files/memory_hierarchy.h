@@ -0,0 +1,146 @@
+// memory_hierarchy.h
+// Cache and memory-hierarchy model for the RV32I core model
+//
+// Replaces the 64-word, zero-latency imem/dmem of riscvsingle.sv with split
+// set-associative I- and D-caches in front of a larger unified main memory.
+// Data always lives in MainMemory; the caches track tags, valid and dirty
+// bits only, which is enough to count hits, misses and writebacks and to
+// estimate the stall cycles a real hierarchy would add.
+//
+// Stall model, in core clock cycles:
+//   hit                      0 (the single-cycle datapath absorbs it)
+//   line fill                latency + lineWords * cyclesPerWord
+//   dirty writeback          latency + lineWords * cyclesPerWord
+//   write-through store      latency + cyclesPerWord (no write buffer)
+//   access with cache off    latency + cyclesPerWord
+
+#ifndef MEMORY_HIERARCHY_H
+#define MEMORY_HIERARCHY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "riscv_model.h"
+
+namespace rv {
+
+enum class Replacement { LRU, FIFO, Random };
+enum class WritePolicy {
+  WriteBack,     // write-allocate; dirty lines written on eviction
+  WriteThrough,  // no-write-allocate; every store goes to memory
+};
+
+struct CacheConfig {
+  uint32_t sizeBytes = 0;  // 0 disables the cache
+  uint32_t lineBytes = 16;
+  uint32_t ways = 1;
+  Replacement replacement = Replacement::LRU;
+  WritePolicy writePolicy = WritePolicy::WriteBack;
+};
+
+// Parses "size:line:ways[:lru|fifo|random[:wb|wt]]", e.g. "4096:32:4:lru:wb",
+// or "off". Throws std::invalid_argument on a malformed spec. An instruction
+// cache is never written, so with writable false the wb|wt field is rejected
+// and describe() leaves the write policy out.
+CacheConfig parseCacheConfig(const std::string &spec, bool writable = true);
+std::string describe(const CacheConfig &config, bool writable = true);
+
+struct CacheStats {
+  uint64_t reads = 0, writes = 0;
+  uint64_t readMisses = 0, writeMisses = 0;
+  uint64_t writebacks = 0;  // Dirty lines written back on eviction
+  uint64_t stallCycles = 0;
+
+  uint64_t accesses() const { return reads + writes; }
+  uint64_t misses() const { return readMisses + writeMisses; }
+  double missRate() const { return accesses() ? double(misses()) / accesses() : 0.0; }
+};
+
+class Cache {
+ public:
+  // Throws std::invalid_argument unless sizes are powers of two that divide evenly.
+  explicit Cache(const CacheConfig &config);
+
+  struct Result {
+    bool hit = false;
+    bool fill = false;       // A line was read from memory
+    bool writeback = false;  // A dirty victim was written to memory
+  };
+
+  Result access(uint32_t addr, bool write);
+  void flush();
+
+  bool enabled() const { return config_.sizeBytes != 0; }
+  const CacheConfig &config() const { return config_; }
+  CacheStats &stats() { return stats_; }
+  const CacheStats &stats() const { return stats_; }
+
+ private:
+  struct Line {
+    uint32_t tag = 0;
+    bool valid = false;
+    bool dirty = false;
+    uint64_t stamp = 0;  // Last use (LRU) or fill time (FIFO)
+  };
+
+  uint32_t victim(uint32_t set);
+
+  CacheConfig config_;
+  uint32_t sets_ = 0;
+  int offsetBits_ = 0, indexBits_ = 0;
+  std::vector<Line> lines_;
+  uint64_t clock_ = 0;
+  uint32_t rng_ = 0x2545F491;
+  CacheStats stats_;
+};
+
+struct MemoryTiming {
+  uint32_t latency = 20;       // Cycles before the first word arrives
+  uint32_t cyclesPerWord = 1;  // Cycles to transfer each 32-bit word
+};
+
+class MainMemory {
+ public:
+  // Throws std::invalid_argument unless sizeBytes is a power of two.
+  explicit MainMemory(uint32_t sizeBytes);
+
+  // Copies image to address base; throws std::out_of_range if it does not fit.
+  void load(const std::vector<uint8_t> &image, uint32_t base = 0);
+  // Out-of-range accesses wrap, like the truncated address of imem/dmem.
+  uint32_t read(uint32_t addr, unsigned bytes) const;
+  void write(uint32_t addr, unsigned bytes, uint32_t value);
+  uint32_t size() const { return static_cast<uint32_t>(bytes_.size()); }
+
+ private:
+  std::vector<uint8_t> bytes_;
+  uint32_t mask_;
+};
+
+class MemoryHierarchy : public MemoryPort {
+ public:
+  MemoryHierarchy(MainMemory &memory, const CacheConfig &icache, const CacheConfig &dcache,
+                  const MemoryTiming &timing)
+      : memory_(memory), icache_(icache), dcache_(dcache), timing_(timing) {}
+
+  uint32_t fetch(uint32_t addr) override;
+  uint32_t load(uint32_t addr, unsigned bytes) override;
+  void store(uint32_t addr, unsigned bytes, uint32_t value) override;
+
+  const Cache &icache() const { return icache_; }
+  const Cache &dcache() const { return dcache_; }
+  uint64_t stallCycles() const {
+    return icache_.stats().stallCycles + dcache_.stats().stallCycles;
+  }
+
+ private:
+  void charge(Cache &cache, uint32_t addr, bool write);
+
+  MainMemory &memory_;
+  Cache icache_, dcache_;
+  MemoryTiming timing_;
+};
+
+}  // namespace rv
+
+#endif
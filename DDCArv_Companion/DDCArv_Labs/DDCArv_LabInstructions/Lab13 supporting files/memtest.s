@@ -0,0 +1,44 @@
+# memtest.s
+#
+# Exercises the memory hierarchy model (riscv_memsim) with a data set much
+# larger than the 64-word dmem of riscvsingle.sv. Fills a 1024-word array at
+# 0x1000, sums it with unit stride, then sums it again 16 words (one 64-byte
+# stride) at a time, which defeats small or direct-mapped D-caches.
+# Uses slli, lui and blt, so it runs on the RV32I model, not riscvsingle.sv.
+# If successful, it writes 523776 to addresses 256 and 260 and loops at done.
+
+#       RISC-V Assembly         Description                  Address   Machine Code
+main:   lui  x10, 1             # x10 = 0x1000 (array base)    0         00001537
+        addi x11, x0, 1024      # x11 = N = 1024 words         4         40000593
+        addi x5, x0, 0          # i = 0                        8         00000293
+        add  x6, x10, x0        # p = base                     C         00050333
+fill:   sw   x5, 0(x6)          # a[i] = i                     10        00532023
+        addi x5, x5, 1          # i++                          14        00128293
+        addi x6, x6, 4          # p += 4                       18        00430313
+        blt  x5, x11, fill      # loop over N words            1C        FEB2CAE3
+        addi x5, x0, 0          # i = 0                        20        00000293
+        add  x6, x10, x0        # p = base                     24        00050333
+        addi x7, x0, 0          # sum1 = 0                     28        00000393
+sum1:   lw   x8, 0(x6)          # x8 = a[i]                    2C        00032403
+        add  x7, x7, x8         # sum1 += a[i]                 30        008383B3
+        addi x5, x5, 1          # i++                          34        00128293
+        addi x6, x6, 4          # p += 4                       38        00430313
+        blt  x5, x11, sum1      # unit stride                  3C        FEB2C8E3
+        addi x12, x0, 0         # sum2 = 0                     40        00000613
+        addi x13, x0, 0         # j = 0                        44        00000693
+        addi x15, x0, 16        # x15 = stride = 16            48        01000793
+outer:  slli x14, x13, 2        # x14 = 4j                     4C        00269713
+        add  x6, x10, x14       # p = &a[j]                    50        00E50333
+        add  x5, x13, x0        # i = j                        54        000682B3
+inner:  lw   x8, 0(x6)          # x8 = a[i]                    58        00032403
+        add  x12, x12, x8       # sum2 += a[i]                 5C        00860633
+        addi x5, x5, 16         # i += 16                      60        01028293
+        addi x6, x6, 64         # p += 64                      64        04030313
+        blt  x5, x11, inner     # stride of 16 words           68        FEB2C8E3
+        addi x13, x13, 1        # j++                          6C        00168693
+        blt  x13, x15, outer    # for j = 0..15                70        FCF6CEE3
+        sw   x7, 0x100(x0)      # mem[256] = sum1 = 523776     74        10702023
+        sw   x12, 0x104(x0)     # mem[260] = sum2 = 523776     78        10C02223
+done:   beq  x7, x12, done      # infinite loop if sums match  7C        00C38063
+        sw   x0, 0x100(x0)      # mem[256] = 0 flags failure   80        10002023
+fail:   beq  x0, x0, fail       # infinite loop                84        00000063
@@ -0,0 +1,134 @@
+// riscv_memsim.cpp
+// Runs RISC-V programs on the RV32I core model behind configurable caches
+// and reports hit/miss rates and estimated stall cycles per program.
+//
+// Build:  g++ -std=c++17 -O2 -o riscv_memsim riscv_memsim.cpp riscv_model.cpp memory_hierarchy.cpp
+// Usage:  riscv_memsim [options] program.txt [program2.txt ...]
+//   -i SPEC   I-cache, size:line:ways[:lru|fifo|random]   (default 1024:16:1:lru)
+//   -d SPEC   D-cache, size:line:ways[:policy[:wb|wt]]    (default 1024:16:2:lru:wb)
+//             "off" sends every access straight to memory
+//   -l N      memory latency in cycles                     (default 20)
+//   -w N      cycles to transfer each word                 (default 1)
+//   -m BYTES  main memory size, a power of two; sp starts at the top
+//                                                          (default 1048576)
+//   -n N      stop after N instructions                    (default 100000000)
+//
+// Example: compare direct-mapped and 4-way D-caches on the Lab 13 test program
+//   riscv_memsim -d 256:16:1 riscvtest.txt
+//   riscv_memsim -d 256:16:4 riscvtest.txt
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "memory_hierarchy.h"
+#include "riscv_model.h"
+
+using namespace rv;
+
+namespace {
+
+struct Options {
+  CacheConfig icache = parseCacheConfig("1024:16:1:lru", false);
+  CacheConfig dcache = parseCacheConfig("1024:16:2:lru:wb");
+  MemoryTiming timing;
+  uint32_t memBytes = 1u << 20;
+  uint64_t maxInstructions = 100000000;
+  std::vector<std::string> programs;
+};
+
+void usage() {
+  std::fprintf(stderr,
+               "usage: riscv_memsim [-i SPEC] [-d SPEC] [-l latency] [-w cycles/word]\n"
+               "                    [-m bytes] [-n max-instructions] program.txt ...\n");
+}
+
+void printCache(const char *name, const Cache &cache, bool writable) {
+  const CacheStats &s = cache.stats();
+  std::printf("  %s %-44s %10llu accesses  %9llu misses  %6.2f%% hit  %7llu wb  %10llu stall\n",
+              name, describe(cache.config(), writable).c_str(), (unsigned long long) s.accesses(),
+              (unsigned long long) s.misses(), 100.0 * (1.0 - s.missRate()),
+              (unsigned long long) s.writebacks, (unsigned long long) s.stallCycles);
+}
+
+int runProgram(const std::string &path, const Options &opt) {
+  std::vector<uint8_t> image;
+  std::string error;
+  MainMemory memory(opt.memBytes);
+  try {
+    if (!loadProgram(path, image, error)) {
+      std::fprintf(stderr, "%s\n", error.c_str());
+      return 1;
+    }
+    memory.load(image);
+  } catch (const std::exception &e) {  // Image too big for memory, or out of host memory
+    std::fprintf(stderr, "%s: %s\n", path.c_str(), e.what());
+    return 1;
+  }
+  MemoryHierarchy hierarchy(memory, opt.icache, opt.dcache, opt.timing);
+  Core core(hierarchy);
+  core.reset(0, opt.memBytes);
+  core.run(opt.maxInstructions);
+
+  const uint64_t n = core.instructions();
+  const uint64_t stalls = hierarchy.stallCycles();
+  std::printf("%s: %llu instructions, %s\n", path.c_str(), (unsigned long long) n,
+              core.halted() ? core.haltReason().c_str() : "instruction limit reached");
+  printCache("I$", hierarchy.icache(), false);
+  printCache("D$", hierarchy.dcache(), true);
+  std::printf("  cycles %llu = %llu instructions + %llu stall, CPI %.3f\n",
+              (unsigned long long) (n + stalls), (unsigned long long) n,
+              (unsigned long long) stalls, n ? double(n + stalls) / n : 0.0);
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options opt;
+
+  try {
+    for (int i = 1; i < argc; i++) {
+      std::string a = argv[i];
+      if (a.size() == 2 && a[0] == '-' && std::strchr("idlwmn", a[1])) {
+        if (++i >= argc) {
+          usage();
+          return 2;
+        }
+        std::string v = argv[i];
+        switch (a[1]) {
+          case 'i': opt.icache = parseCacheConfig(v, false); break;
+          case 'd': opt.dcache = parseCacheConfig(v); break;
+          case 'l': opt.timing.latency = static_cast<uint32_t>(std::stoul(v)); break;
+          case 'w': opt.timing.cyclesPerWord = static_cast<uint32_t>(std::stoul(v)); break;
+          case 'm': opt.memBytes = static_cast<uint32_t>(std::stoul(v)); break;
+          case 'n': opt.maxInstructions = std::stoull(v); break;
+        }
+      } else if (a[0] == '-') {
+        usage();
+        return 2;
+      } else {
+        opt.programs.push_back(a);
+      }
+    }
+    if (opt.programs.empty()) {
+      usage();
+      return 2;
+    }
+
+    // Check the configuration once, before any program runs
+    Cache(opt.icache);
+    Cache(opt.dcache);
+    MainMemory(opt.memBytes);
+
+    int failed = 0;
+    for (const std::string &p : opt.programs) failed |= runProgram(p, opt);
+    return failed;
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "riscv_memsim: %s\n", e.what());
+    return 2;
+  }
+}
@@ -0,0 +1,237 @@
+// riscv_model.cpp
+// Instruction-level C++ model of an RV32I core
+
+#include "riscv_model.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace rv {
+
+namespace {
+
+constexpr uint32_t OP_LOAD = 0b0000011, OP_IMM = 0b0010011, OP_AUIPC = 0b0010111,
+                   OP_STORE = 0b0100011, OP_REG = 0b0110011, OP_LUI = 0b0110111,
+                   OP_BRANCH = 0b1100011, OP_JALR = 0b1100111, OP_JAL = 0b1101111,
+                   OP_SYSTEM = 0b1110011, OP_FENCE = 0b0001111;
+
+inline int32_t sext(uint32_t v, int bits) {
+  return static_cast<int32_t>(v << (32 - bits)) >> (32 - bits);
+}
+
+inline int32_t immI(uint32_t i) { return static_cast<int32_t>(i) >> 20; }
+inline int32_t immS(uint32_t i) {
+  return sext(((i >> 25) << 5) | ((i >> 7) & 0x1F), 12);
+}
+inline int32_t immB(uint32_t i) {
+  return sext(((i >> 31) << 12) | (((i >> 7) & 1) << 11) | (((i >> 25) & 0x3F) << 5) |
+              (((i >> 8) & 0xF) << 1), 13);
+}
+inline int32_t immJ(uint32_t i) {
+  return sext(((i >> 31) << 20) | (((i >> 12) & 0xFF) << 12) | (((i >> 20) & 1) << 11) |
+              (((i >> 21) & 0x3FF) << 1), 21);
+}
+
+std::string hex(uint32_t v) {
+  std::ostringstream s;
+  s << "0x" << std::hex << v;
+  return s.str();
+}
+
+}  // namespace
+
+void Core::reset(uint32_t pc, uint32_t sp) {
+  std::memset(x_, 0, sizeof(x_));
+  x_[2] = sp;
+  pc_ = pc;
+  halted_ = false;
+  haltReason_.clear();
+  instructions_ = 0;
+}
+
+bool Core::step(Retired *info) {
+  if (halted_) return false;
+
+  const uint32_t instr = mem_.fetch(pc_);
+  const uint32_t op = instr & 0x7F;
+  const uint32_t rd = (instr >> 7) & 31;
+  const uint32_t funct3 = (instr >> 12) & 7;
+  const uint32_t rs1 = x_[(instr >> 15) & 31];
+  const uint32_t rs2 = x_[(instr >> 20) & 31];
+  const bool funct7b5 = (instr >> 30) & 1;
+
+  uint32_t next = pc_ + 4;
+  uint32_t result = 0;
+  bool writeRd = true;
+  Retired r;
+  r.pc = pc_;
+  r.instr = instr;
+
+  switch (op) {
+    case OP_LUI:
+      result = instr & 0xFFFFF000;
+      break;
+    case OP_AUIPC:
+      result = pc_ + (instr & 0xFFFFF000);
+      break;
+    case OP_JAL:
+      result = next;
+      next = pc_ + immJ(instr);
+      r.taken = true;
+      break;
+    case OP_JALR:
+      result = next;
+      next = (rs1 + immI(instr)) & ~1u;
+      r.taken = true;
+      break;
+    case OP_BRANCH: {
+      bool t;
+      switch (funct3) {
+        case 0: t = rs1 == rs2; break;
+        case 1: t = rs1 != rs2; break;
+        case 4: t = static_cast<int32_t>(rs1) < static_cast<int32_t>(rs2); break;
+        case 5: t = static_cast<int32_t>(rs1) >= static_cast<int32_t>(rs2); break;
+        case 6: t = rs1 < rs2; break;
+        case 7: t = rs1 >= rs2; break;
+        default: halt("illegal branch at " + hex(pc_)); return false;
+      }
+      r.branch = true;
+      r.taken = t;
+      if (t) next = pc_ + immB(instr);
+      writeRd = false;
+      break;
+    }
+    case OP_LOAD: {
+      uint32_t addr = rs1 + immI(instr);
+      r.load = true;
+      r.memAddr = addr;
+      switch (funct3) {
+        case 0: result = static_cast<uint32_t>(sext(mem_.load(addr, 1), 8)); break;
+        case 1: result = static_cast<uint32_t>(sext(mem_.load(addr, 2), 16)); break;
+        case 2: result = mem_.load(addr, 4); break;
+        case 4: result = mem_.load(addr, 1); break;
+        case 5: result = mem_.load(addr, 2); break;
+        default: halt("illegal load at " + hex(pc_)); return false;
+      }
+      break;
+    }
+    case OP_STORE: {
+      uint32_t addr = rs1 + immS(instr);
+      r.store = true;
+      r.memAddr = addr;
+      if (funct3 > 2) {
+        halt("illegal store at " + hex(pc_));
+        return false;
+      }
+      mem_.store(addr, 1u << funct3, rs2);
+      writeRd = false;
+      break;
+    }
+    case OP_IMM:
+    case OP_REG: {
+      const bool reg = op == OP_REG;
+      const uint32_t b = reg ? rs2 : static_cast<uint32_t>(immI(instr));
+      const uint32_t shamt = b & 31;
+      switch (funct3) {
+        case 0: result = (reg && funct7b5) ? rs1 - b : rs1 + b; break;
+        case 1: result = rs1 << shamt; break;
+        case 2: result = static_cast<int32_t>(rs1) < static_cast<int32_t>(b); break;
+        case 3: result = rs1 < b; break;
+        case 4: result = rs1 ^ b; break;
+        case 5:
+          result = funct7b5 ? static_cast<uint32_t>(static_cast<int32_t>(rs1) >> shamt)
+                            : rs1 >> shamt;
+          break;
+        case 6: result = rs1 | b; break;
+        case 7: result = rs1 & b; break;
+      }
+      break;
+    }
+    case OP_FENCE:
+      writeRd = false;
+      break;
+    case OP_SYSTEM:
+      halt(((instr >> 20) & 1) ? "ebreak" : "ecall");
+      writeRd = false;
+      break;
+    default:
+      halt("illegal instruction " + hex(instr) + " at " + hex(pc_));
+      return false;
+  }
+
+  if (writeRd && rd != 0) x_[rd] = result;
+  r.nextPc = next;
+  if (info) *info = r;
+  instructions_++;
+
+  if (next == pc_ && !halted_) halt("jump to self at " + hex(pc_));
+  pc_ = next;
+  return !halted_;
+}
+
+uint64_t Core::run(uint64_t maxInstructions) {
+  uint64_t start = instructions_;
+  while (instructions_ - start < maxInstructions && step()) {
+  }
+  return instructions_ - start;
+}
+
+bool loadProgram(const std::string &path, std::vector<uint8_t> &image, std::string &error) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    error = "cannot open " + path;
+    return false;
+  }
+  image.clear();
+
+  if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0) {
+    image.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+  }
+
+  // Largest image a $readmemh file may describe; the biggest MainMemory is
+  // 2 GiB, and @addresses beyond that could only be typos.
+  constexpr uint64_t kMaxImageBytes = uint64_t(1) << 31;
+  std::string line;
+  uint64_t addr = 0;  // Word address, as in $readmemh
+  for (int lineNum = 1; std::getline(file, line); lineNum++) {
+    size_t comment = line.find("//");
+    if (comment != std::string::npos) line.resize(comment);
+    std::istringstream tokens(line);
+    std::string tok;
+    while (tokens >> tok) {
+      bool at = tok[0] == '@';
+      const std::string digits = at ? tok.substr(1) : tok;
+      if (digits.empty() || digits.find_first_not_of("0123456789abcdefABCDEF_") != std::string::npos) {
+        error = path + ":" + std::to_string(lineNum) + ": bad token '" + tok + "'";
+        return false;
+      }
+      std::string clean;
+      for (char c : digits)
+        if (c != '_') clean += c;
+      if (clean.empty() || clean.size() > 8) {
+        error = path + ":" + std::to_string(lineNum) + ": bad token '" + tok + "'";
+        return false;
+      }
+      uint32_t v = static_cast<uint32_t>(std::stoul(clean, nullptr, 16));
+      if (at) {
+        addr = v;
+        continue;
+      }
+      const uint64_t end = (addr + 1) * 4;
+      if (end > kMaxImageBytes) {
+        error = path + ":" + std::to_string(lineNum) + ": word address " + hex(static_cast<uint32_t>(addr)) +
+                " is beyond the 2 GiB image limit";
+        return false;
+      }
+      if (image.size() < end) image.resize(static_cast<size_t>(end));
+      for (int b = 0; b < 4; b++)
+        image[static_cast<size_t>(addr * 4 + b)] = static_cast<uint8_t>(v >> (8 * b));
+      addr++;
+    }
+  }
+  return true;
+}
+
+}  // namespace rv
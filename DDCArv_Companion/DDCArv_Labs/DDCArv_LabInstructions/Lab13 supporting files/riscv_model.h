@@ -0,0 +1,82 @@
+// riscv_model.h
+// Instruction-level C++ model of an RV32I core
+//
+// Executes the base integer instruction set one instruction per step, the way
+// riscvsingle.sv retires one instruction per cycle. Instruction fetches, loads
+// and stores go through a MemoryPort so a memory hierarchy (see
+// memory_hierarchy.h) can sit between the core and backing memory.
+// Exceptions and CSRs are not modelled; ecall, ebreak, an illegal instruction
+// or a jump to itself (the "done: beq x2, x2, done" idiom) halts the core.
+
+#ifndef RISCV_MODEL_H
+#define RISCV_MODEL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rv {
+
+class MemoryPort {
+ public:
+  virtual ~MemoryPort() = default;
+  virtual uint32_t fetch(uint32_t addr) = 0;
+  // Returns bytes (1, 2 or 4) at addr, zero-extended.
+  virtual uint32_t load(uint32_t addr, unsigned bytes) = 0;
+  virtual void store(uint32_t addr, unsigned bytes, uint32_t value) = 0;
+};
+
+// What the last step did, for tools that watch execution.
+struct Retired {
+  uint32_t pc = 0;
+  uint32_t instr = 0;
+  uint32_t nextPc = 0;
+  bool branch = false;    // Conditional branch
+  bool taken = false;     // Branch taken (always true for jal/jalr)
+  bool load = false;
+  bool store = false;
+  uint32_t memAddr = 0;   // Effective address of a load or store
+};
+
+class Core {
+ public:
+  explicit Core(MemoryPort &mem) : mem_(mem) { reset(0, 0); }
+
+  // Clears the registers, sets pc and the stack pointer (x2).
+  void reset(uint32_t pc, uint32_t sp);
+
+  // Executes one instruction. Returns false once the core has halted.
+  bool step(Retired *info = nullptr);
+
+  // Steps until halted or maxInstructions have retired; returns the number retired.
+  uint64_t run(uint64_t maxInstructions);
+
+  uint32_t pc() const { return pc_; }
+  uint32_t reg(int r) const { return x_[r & 31]; }
+  bool halted() const { return halted_; }
+  const std::string &haltReason() const { return haltReason_; }
+  uint64_t instructions() const { return instructions_; }
+
+ private:
+  void halt(const std::string &reason) {
+    halted_ = true;
+    haltReason_ = reason;
+  }
+
+  MemoryPort &mem_;
+  uint32_t x_[32];
+  uint32_t pc_ = 0;
+  bool halted_ = false;
+  std::string haltReason_;
+  uint64_t instructions_ = 0;
+};
+
+// Reads a program image. Files ending in .bin are raw little-endian bytes;
+// anything else is $readmemh format (one hex word per line, // comments and
+// @address lines allowed), like riscvtest.txt. Returns false and sets error
+// on failure.
+bool loadProgram(const std::string &path, std::vector<uint8_t> &image, std::string &error);
+
+}  // namespace rv
+
+#endif
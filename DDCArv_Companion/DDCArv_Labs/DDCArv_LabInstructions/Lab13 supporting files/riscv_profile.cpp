@@ -0,0 +1,194 @@
+// riscv_profile.cpp
+// Profiles a RISC-V program on the RV32I core model: instruction mix, hot PCs,
+// branch behaviour, data-access heatmap and folded call stacks.
+//
+// Build:  g++ -std=c++17 -O2 -o riscv_profile riscv_profile.cpp guest_profiler.cpp riscv_model.cpp memory_hierarchy.cpp
+// Usage:  riscv_profile [options] program.txt
+//   -o PREFIX  write PREFIX.mix.csv, .pcs.csv, .branches.csv, .mem.csv and .folded
+//              (default: the program name without its extension)
+//   -t N       hot PCs to list in the summary                (default 10)
+//   -b BYTES   heatmap block size, a power of two            (default 64)
+//   -m BYTES   main memory size, a power of two; sp starts at the top
+//                                                          (default 1048576)
+//   -n N       stop after N instructions                     (default 100000000)
+//   -x         also time an unprofiled run and report the profiler overhead
+//
+// Example: profile the Lab 13 test program and draw a flame graph
+//   riscv_profile riscvtest.txt
+//   flamegraph.pl riscvtest.folded > riscvtest.svg
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "guest_profiler.h"
+#include "memory_hierarchy.h"
+#include "riscv_model.h"
+
+using namespace rv;
+
+namespace {
+
+struct Options {
+  std::string program, prefix;
+  size_t top = 10;
+  uint32_t blockBytes = 64;
+  uint32_t memBytes = 1u << 20;
+  uint64_t maxInstructions = 100000000;
+  bool baseline = false;
+};
+
+// Zero-latency memory: the profiler counts instructions, not cycles.
+class FlatMemory : public MemoryPort {
+ public:
+  explicit FlatMemory(MainMemory &memory) : memory_(memory) {}
+  uint32_t fetch(uint32_t addr) override { return memory_.read(addr, 4); }
+  uint32_t load(uint32_t addr, unsigned bytes) override { return memory_.read(addr, bytes); }
+  void store(uint32_t addr, unsigned bytes, uint32_t value) override {
+    memory_.write(addr, bytes, value);
+  }
+
+ private:
+  MainMemory &memory_;
+};
+
+void usage() {
+  std::fprintf(stderr,
+               "usage: riscv_profile [-o prefix] [-t top] [-b block-bytes] [-m bytes]\n"
+               "                     [-n max-instructions] [-x] program.txt\n");
+}
+
+double seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Runs the program once; profiles it when profiler is non-null.
+uint64_t execute(const std::vector<uint8_t> &image, const Options &opt, GuestProfiler *profiler,
+                 std::string *haltReason) {
+  MainMemory memory(opt.memBytes);
+  memory.load(image);
+  FlatMemory port(memory);
+  Core core(port);
+  core.reset(0, opt.memBytes);
+
+  if (profiler) {
+    // step() returns false on the instruction that halts the core, but that
+    // instruction still retires and must be recorded.
+    Retired r;
+    for (uint64_t i = 0; i < opt.maxInstructions; i++) {
+      const uint64_t before = core.instructions();
+      const bool running = core.step(&r);
+      if (core.instructions() != before) profiler->record(r);
+      if (!running) break;
+    }
+    if (profiler->instructions() != core.instructions())
+      throw std::logic_error("profiler recorded " + std::to_string(profiler->instructions()) +
+                             " instructions, core retired " +
+                             std::to_string(core.instructions()));
+  } else {
+    core.run(opt.maxInstructions);
+  }
+  if (haltReason) *haltReason = core.halted() ? core.haltReason() : "instruction limit reached";
+  return core.instructions();
+}
+
+void writeReport(const std::string &path, const GuestProfiler &profiler,
+                 void (GuestProfiler::*write)(std::ostream &) const) {
+  std::ofstream out(path);
+  if (!out) throw std::runtime_error("cannot write " + path);
+  (profiler.*write)(out);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options opt;
+
+  try {
+    for (int i = 1; i < argc; i++) {
+      std::string a = argv[i];
+      if (a == "-x") {
+        opt.baseline = true;
+      } else if (a.size() == 2 && a[0] == '-' && std::strchr("otbmn", a[1])) {
+        if (++i >= argc) {
+          usage();
+          return 2;
+        }
+        std::string v = argv[i];
+        switch (a[1]) {
+          case 'o': opt.prefix = v; break;
+          case 't': opt.top = std::stoul(v); break;
+          case 'b': opt.blockBytes = static_cast<uint32_t>(std::stoul(v)); break;
+          case 'm': opt.memBytes = static_cast<uint32_t>(std::stoul(v)); break;
+          case 'n': opt.maxInstructions = std::stoull(v); break;
+        }
+      } else if (a[0] == '-' || !opt.program.empty()) {
+        usage();
+        return 2;
+      } else {
+        opt.program = a;
+      }
+    }
+    if (opt.program.empty() || opt.blockBytes == 0 || (opt.blockBytes & (opt.blockBytes - 1))) {
+      usage();
+      return 2;
+    }
+    if (opt.prefix.empty()) {  // Strip the extension from the file name, not the directories
+      const size_t slash = opt.program.rfind('/');
+      const size_t dot = opt.program.rfind('.');
+      const size_t base = slash == std::string::npos ? 0 : slash + 1;
+      opt.prefix = dot != std::string::npos && dot > base ? opt.program.substr(0, dot) : opt.program;
+    }
+
+    std::vector<uint8_t> image;
+    std::string error;
+    if (!loadProgram(opt.program, image, error)) {
+      std::fprintf(stderr, "%s\n", error.c_str());
+      return 1;
+    }
+
+    GuestProfiler profiler(0, opt.blockBytes, opt.memBytes);
+    std::string halt;
+    auto start = std::chrono::steady_clock::now();
+    const uint64_t n = execute(image, opt, &profiler, &halt);
+    const double profiled = seconds(start);
+
+    std::printf("%s: %llu instructions, %s\n", opt.program.c_str(), (unsigned long long) n,
+                halt.c_str());
+    std::printf("  profiled run %.3f s (%.1f M instructions/s)\n", profiled,
+                profiled > 0 ? n / profiled / 1e6 : 0.0);
+    if (opt.baseline) {
+      start = std::chrono::steady_clock::now();
+      execute(image, opt, nullptr, nullptr);
+      const double plain = seconds(start);
+      std::printf("  plain run    %.3f s, profiler overhead %.1f%%\n", plain,
+                  plain > 0 ? 100.0 * (profiled - plain) / plain : 0.0);
+    }
+
+    // Summary: the mix and the hottest PCs, straight from the CSV writers.
+    std::ostringstream mix, pcs;
+    profiler.writeMix(mix);
+    profiler.writeHotPcs(pcs, opt.top);
+    std::printf("\ninstruction mix\n%s\nhot PCs\n%s", mix.str().c_str(), pcs.str().c_str());
+
+    writeReport(opt.prefix + ".mix.csv", profiler, &GuestProfiler::writeMix);
+    writeReport(opt.prefix + ".branches.csv", profiler, &GuestProfiler::writeBranches);
+    writeReport(opt.prefix + ".mem.csv", profiler, &GuestProfiler::writeMemory);
+    writeReport(opt.prefix + ".folded", profiler, &GuestProfiler::writeFolded);
+    std::ofstream hot(opt.prefix + ".pcs.csv");
+    if (!hot) throw std::runtime_error("cannot write " + opt.prefix + ".pcs.csv");
+    profiler.writeHotPcs(hot);
+
+    std::printf("\nwrote %s.{mix,pcs,branches,mem}.csv and %s.folded\n", opt.prefix.c_str(),
+                opt.prefix.c_str());
+    return 0;
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "riscv_profile: %s\n", e.what());
+    return 2;
+  }
+}
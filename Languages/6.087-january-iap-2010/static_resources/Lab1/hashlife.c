@@ -0,0 +1,381 @@
+/*
+ * hashlife.c
+ *
+ *  Memoized quadtree (HashLife) evolution of a bit-packed world
+ */
+
+/* The plane is a quadtree: a level-k node is a 2^k x 2^k square made of four
+   level-(k-1) quadrants, and a level-0 node is a single cell. Nodes are
+   hash-consed, so identical squares anywhere in space or time are the same
+   node, and each node remembers its successor: the centre 2^(k-1) square
+   advanced 2^j generations (j <= k-2). Repeated and empty regions, which
+   dominate sparse patterns like gliders and spaceships, are then computed
+   once. See Gosper, "Exploiting regularities in large cellular spaces",
+   Physica D 10 (1984). */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lifegame.h"
+#include "hashlife.h"
+
+#define MAX_LEVEL 64
+#define NODES_PER_BLOCK 65536
+/* node count above which unreachable nodes and memos are discarded */
+#define GC_NODES (1L << 22)
+
+typedef struct node {
+	struct node *nw, *ne, *sw, *se; /* quadrants; NULL at level 0 */
+	struct node *next;              /* hash chain */
+	struct node *result;            /* memoized successor */
+	int result_step;                /* j of result; -1 if none */
+	int level;
+	uint64_t population;
+} node;
+
+typedef struct universe {
+	node **table;
+	size_t buckets, count;
+	node **blocks;      /* node storage, NODES_PER_BLOCK per block */
+	size_t nblocks, used;
+	node *leaf[2];      /* the DEAD and ALIVE cells */
+	node *empty[MAX_LEVEL];
+} universe;
+
+/* view of the caller's world */
+typedef struct world {
+	uint64_t *grid;
+	int width, height;
+	size_t stride, words;
+} world;
+
+static void out_of_memory(void) {
+	fprintf(stderr,"Error: out of memory in hashlife.\n");
+	abort();
+}
+
+static node *alloc_node(universe *u) {
+	if (u->nblocks == 0 || u->used == NODES_PER_BLOCK) {
+		node **blocks = realloc(u->blocks, (u->nblocks + 1) * sizeof(*blocks));
+		if (blocks == NULL)
+			out_of_memory();
+		u->blocks = blocks;
+		if ((u->blocks[u->nblocks] = malloc(NODES_PER_BLOCK * sizeof(node))) == NULL)
+			out_of_memory();
+		u->nblocks++;
+		u->used = 0;
+	}
+	return &u->blocks[u->nblocks - 1][u->used++];
+}
+
+static size_t hash_children(const node *nw, const node *ne, const node *sw,
+		const node *se) {
+	uint64_t h = (uintptr_t)nw;
+	h = h * 0x9E3779B97F4A7C15ULL + (uintptr_t)ne;
+	h = h * 0x9E3779B97F4A7C15ULL + (uintptr_t)sw;
+	h = h * 0x9E3779B97F4A7C15ULL + (uintptr_t)se;
+	return (size_t)(h ^ (h >> 29));
+}
+
+static void grow_table(universe *u) {
+	size_t buckets = u->buckets ? 2 * u->buckets : 1024, i;
+	node **table = calloc(buckets, sizeof(*table));
+	node *n, *next;
+
+	if (table == NULL)
+		out_of_memory();
+	for (i = 0; i < u->buckets; i++)
+		for (n = u->table[i]; n != NULL; n = next) {
+			size_t b = hash_children(n->nw, n->ne, n->sw, n->se) & (buckets - 1);
+			next = n->next;
+			n->next = table[b];
+			table[b] = n;
+		}
+	free(u->table);
+	u->table = table;
+	u->buckets = buckets;
+}
+
+/* returns the unique node with the given quadrants */
+static node *find_node(universe *u, node *nw, node *ne, node *sw, node *se) {
+	size_t b;
+	node *n;
+
+	if (u->count >= u->buckets)
+		grow_table(u);
+	b = hash_children(nw, ne, sw, se) & (u->buckets - 1);
+	for (n = u->table[b]; n != NULL; n = n->next)
+		if (n->nw == nw && n->ne == ne && n->sw == sw && n->se == se)
+			return n;
+
+	n = alloc_node(u);
+	n->nw = nw; n->ne = ne; n->sw = sw; n->se = se;
+	n->result = NULL;
+	n->result_step = -1;
+	n->level = nw->level + 1;
+	n->population = nw->population + ne->population + sw->population + se->population;
+	n->next = u->table[b];
+	u->table[b] = n;
+	u->count++;
+	return n;
+}
+
+static void init_universe(universe *u) {
+	int k;
+
+	memset(u, 0, sizeof(*u));
+	for (k = 0; k < 2; k++) {
+		u->leaf[k] = alloc_node(u);
+		memset(u->leaf[k], 0, sizeof(node));
+		u->leaf[k]->result_step = -1;
+		u->leaf[k]->population = k;
+	}
+	u->empty[0] = u->leaf[DEAD];
+	for (k = 1; k < MAX_LEVEL; k++)
+		u->empty[k] = find_node(u, u->empty[k-1], u->empty[k-1],
+				u->empty[k-1], u->empty[k-1]);
+}
+
+static void free_universe(universe *u) {
+	size_t i;
+
+	for (i = 0; i < u->nblocks; i++)
+		free(u->blocks[i]);
+	free(u->blocks);
+	free(u->table);
+}
+
+/* centre 2^(k-1) square of a level-k node, k >= 2 */
+static node *centre(universe *u, const node *n) {
+	return find_node(u, n->nw->se, n->ne->sw, n->sw->ne, n->se->nw);
+}
+
+/* level-1 centre of a 4x4 node advanced one generation */
+static node *step_leaf_square(universe *u, const node *n) {
+	const node *q[4] = { n->nw, n->ne, n->sw, n->se };
+	int cells[4][4], x, y, i, dx, dy, sum, alive;
+	node *out[4];
+
+	for (i = 0; i < 4; i++) {
+		int ox = (i & 1) * 2, oy = (i >> 1) * 2;
+		cells[oy][ox] = (int)q[i]->nw->population;
+		cells[oy][ox+1] = (int)q[i]->ne->population;
+		cells[oy+1][ox] = (int)q[i]->sw->population;
+		cells[oy+1][ox+1] = (int)q[i]->se->population;
+	}
+	for (i = 0; i < 4; i++) {
+		x = 1 + (i & 1);
+		y = 1 + (i >> 1);
+		sum = 0;
+		for (dy = -1; dy <= 1; dy++)
+			for (dx = -1; dx <= 1; dx++)
+				if (dx || dy)
+					sum += cells[y+dy][x+dx];
+		alive = sum == 3 || (sum == 2 && cells[y][x]);
+		out[i] = u->leaf[alive];
+	}
+	return find_node(u, out[0], out[1], out[2], out[3]);
+}
+
+/* centre 2^(k-1) square of a level-k node advanced 2^j generations, j <= k-2 */
+static node *successor(universe *u, node *n, int j) {
+	node *n00, *n01, *n02, *n10, *n11, *n12, *n20, *n21, *n22;
+	node *r00, *r01, *r02, *r10, *r11, *r12, *r20, *r21, *r22;
+	node *result;
+	int full = j == n->level - 2;
+
+	if (n->population == 0)
+		return u->empty[n->level - 1];
+	if (n->result_step == j)
+		return n->result;
+	if (n->level == 2) {
+		result = step_leaf_square(u, n);
+	} else {
+		/* nine overlapping level-(k-1) squares */
+		n00 = n->nw;
+		n01 = find_node(u, n->nw->ne, n->ne->nw, n->nw->se, n->ne->sw);
+		n02 = n->ne;
+		n10 = find_node(u, n->nw->sw, n->nw->se, n->sw->nw, n->sw->ne);
+		n11 = centre(u, n);
+		n12 = find_node(u, n->ne->sw, n->ne->se, n->se->nw, n->se->ne);
+		n20 = n->sw;
+		n21 = find_node(u, n->sw->ne, n->se->nw, n->sw->se, n->se->sw);
+		n22 = n->se;
+
+		/* at full speed both halves advance 2^(k-3) generations; otherwise
+		   the first half only recentres and the second advances 2^j */
+		if (full) {
+			r00 = successor(u, n00, j - 1); r01 = successor(u, n01, j - 1);
+			r02 = successor(u, n02, j - 1); r10 = successor(u, n10, j - 1);
+			r11 = successor(u, n11, j - 1); r12 = successor(u, n12, j - 1);
+			r20 = successor(u, n20, j - 1); r21 = successor(u, n21, j - 1);
+			r22 = successor(u, n22, j - 1);
+		} else {
+			r00 = centre(u, n00); r01 = centre(u, n01); r02 = centre(u, n02);
+			r10 = centre(u, n10); r11 = centre(u, n11); r12 = centre(u, n12);
+			r20 = centre(u, n20); r21 = centre(u, n21); r22 = centre(u, n22);
+		}
+		if (full)
+			j--;
+		result = find_node(u,
+				successor(u, find_node(u, r00, r01, r10, r11), j),
+				successor(u, find_node(u, r01, r02, r11, r12), j),
+				successor(u, find_node(u, r10, r11, r20, r21), j),
+				successor(u, find_node(u, r11, r12, r21, r22), j));
+		if (full)
+			j++;
+	}
+	n->result = result;
+	n->result_step = j;
+	return result;
+}
+
+/* level-(k+1) node with n in its centre */
+static node *expand(universe *u, const node *n) {
+	node *e = u->empty[n->level - 1];
+
+	return find_node(u,
+			find_node(u, e, e, e, n->nw),
+			find_node(u, e, e, n->ne, e),
+			find_node(u, e, n->sw, e, e),
+			find_node(u, n->se, e, e, e));
+}
+
+/* nonzero if all live cells lie in the centre 2^(k-1) square */
+static int is_centred(const node *n) {
+	if (n->level < 2)
+		return 0;
+	return n->nw->nw->population + n->nw->ne->population + n->nw->sw->population +
+		n->ne->nw->population + n->ne->ne->population + n->ne->se->population +
+		n->sw->nw->population + n->sw->sw->population + n->sw->se->population +
+		n->se->ne->population + n->se->sw->population + n->se->se->population == 0;
+}
+
+/* copies the tree under n into a fresh universe. The old node's result
+   field is reused to record its copy, as the old universe is about to be
+   freed */
+static node *copy_tree(universe *to, node *n) {
+	node *copy;
+
+	if (n->result_step == -2)
+		return n->result;
+	if (n->level == 0)
+		copy = to->leaf[n->population != 0];
+	else if (n->population == 0)
+		copy = to->empty[n->level];
+	else
+		copy = find_node(to, copy_tree(to, n->nw), copy_tree(to, n->ne),
+				copy_tree(to, n->sw), copy_tree(to, n->se));
+	n->result = copy;
+	n->result_step = -2;
+	return copy;
+}
+
+/* nonzero if the world has no live cells in the 2^level square at (x0,y0);
+   x0 is a multiple of the square's size */
+static int region_empty(const world *w, long x0, long y0, int level) {
+	long size = 1L << level, y, y1 = y0 + size < w->height ? y0 + size : w->height;
+	size_t i, i0, i1;
+	uint64_t mask;
+
+	if (level < 6) {
+		mask = (((uint64_t)1 << size) - 1) << (x0 & 63);
+		for (y = y0; y < y1; y++)
+			if (w->grid[y * w->stride + (x0 >> 6)] & mask)
+				return 0;
+		return 1;
+	}
+	i0 = (size_t)(x0 >> 6);
+	i1 = (size_t)((x0 + size) >> 6) < w->words ? (size_t)((x0 + size) >> 6) : w->words;
+	for (y = y0; y < y1; y++)
+		for (i = i0; i < i1; i++)
+			if (w->grid[y * w->stride + i])
+				return 0;
+	return 1;
+}
+
+static node *build(universe *u, const world *w, long x0, long y0, int level) {
+	long half;
+
+	if (x0 >= w->width || y0 >= w->height || region_empty(w, x0, y0, level))
+		return u->empty[level];
+	if (level == 0)
+		return u->leaf[ALIVE];
+	half = 1L << (level - 1);
+	return find_node(u, build(u, w, x0, y0, level - 1),
+			build(u, w, x0 + half, y0, level - 1),
+			build(u, w, x0, y0 + half, level - 1),
+			build(u, w, x0 + half, y0 + half, level - 1));
+}
+
+/* writes the live cells of n, whose top-left corner is (x0,y0), into w */
+static void store(const world *w, const node *n, long x0, long y0) {
+	long size, half;
+
+	if (n->population == 0 || x0 >= w->width || y0 >= w->height)
+		return;
+	size = 1L << n->level;
+	if (x0 + size <= 0 || y0 + size <= 0)
+		return;
+	if (n->level == 0) {
+		w->grid[y0 * w->stride + (x0 >> 6)] |= (uint64_t)1 << (x0 & 63);
+		return;
+	}
+	half = size / 2;
+	store(w, n->nw, x0, y0);
+	store(w, n->ne, x0 + half, y0);
+	store(w, n->sw, x0, y0 + half);
+	store(w, n->se, x0 + half, y0 + half);
+}
+
+void hashlife_evolve(uint64_t *grid, int width, int height, size_t stride,
+		long generations) {
+	world w = { grid, width, height, stride, ((size_t)width + 63) / 64 };
+	universe u, fresh;
+	node *root;
+	long x0 = 0, y0 = 0, half;
+	int level = 3, j, y;
+
+	while ((1L << level) < width || (1L << level) < height)
+		level++;
+	init_universe(&u);
+	root = build(&u, &w, 0, 0, level);
+
+	for (j = 0; generations >> j; j++) {
+		if (!((generations >> j) & 1))
+			continue;
+		/* grow until the pattern sits in the centre quarter of a root big
+		   enough to take a 2^j step without losing any cells */
+		while (root->level < j + 2 || !is_centred(root)) {
+			half = 1L << (root->level - 1);
+			root = expand(&u, root);
+			x0 -= half;
+			y0 -= half;
+		}
+		half = 1L << (root->level - 1);
+		root = expand(&u, root);
+		x0 -= half;
+		y0 -= half;
+		if (root->level >= MAX_LEVEL - 1) {
+			fprintf(stderr,"Error: pattern too large for hashlife.\n");
+			abort();
+		}
+
+		root = successor(&u, root, j);
+		x0 += 1L << (root->level - 1);
+		y0 += 1L << (root->level - 1);
+
+		if ((long)u.count > GC_NODES) {
+			init_universe(&fresh);
+			root = copy_tree(&fresh, root);
+			free_universe(&u);
+			u = fresh;
+		}
+	}
+
+	for (y = 0; y < height; y++)
+		memset(grid + (size_t)y * stride, 0, w.words * sizeof(uint64_t));
+	store(&w, root, x0, y0);
+	free_universe(&u);
+}
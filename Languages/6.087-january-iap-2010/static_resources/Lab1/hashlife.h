@@ -0,0 +1,22 @@
+/*
+ * hashlife.h
+ *
+ *  Memoized quadtree (HashLife) evolution of a bit-packed world
+ */
+
+#ifndef HASHLIFE_H_
+#define HASHLIFE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* advances the cells of a bit-packed world by 'generations' generations on
+   an unbounded plane and writes the result back; cells that end up outside
+   the world are dropped.
+
+   Row y of the world starts at grid + y*stride; cell x is bit x%64 of word
+   x/64, and bits past 'width' in the last word of each row are zero */
+void hashlife_evolve(uint64_t *grid, int width, int height, size_t stride,
+		long generations);
+
+#endif /* HASHLIFE_H_ */
@@ -0,0 +1,403 @@
+/*
+ * lifegame.c
+ *
+ *  Bit-packed, multi-threaded implementation of lifegame.h
+ *
+ *  Build (with a driver such as lab1b.c or lifegame_bench.c):
+ *    gcc -O3 -march=native -pthread lab1b.c lifegame.c hashlife.c
+ */
+
+/* Cells are packed 64 per word, row by row, so a word holds 64 horizontally
+   adjacent cells. Each row has a DEAD guard word on either side and the
+   world has a DEAD guard row above and below, so the neighbourhood of every
+   word can be read without bounds checks.
+
+   evolve_world() computes 64 cells at a time with bitwise adders (see
+   step_band()); the loop has no branches, and GCC vectorizes it with AVX2
+   or AVX-512 under -march=native. Rows are split into bands that are
+   stepped in parallel, with one barrier per generation.
+
+   get_cell_state()/set_cell_state()/finalize_evolution() keep their
+   original meaning, so programs written against lifegame.h still work. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "lifegame.h"
+#include "lifegame_ext.h"
+#include "hashlife.h"
+
+/* default world size, as in the original lab */
+#define WORLDWIDTH 39
+#define WORLDHEIGHT 20
+
+/* character representations of cell states */
+#define CHAR_ALIVE '*'
+#define CHAR_DEAD ' '
+
+/* fewest rows worth giving to a thread of their own */
+#define MIN_BAND_ROWS 64
+
+static int width, height;
+static size_t words;     /* words per row */
+static size_t stride;    /* words per row, including the guard words */
+static uint64_t lastmask; /* cells of the last word of a row inside the world */
+
+/* grids[cur] holds the current cell states, grids[!cur] the next generation */
+static uint64_t *grids[2];
+static int cur;
+
+static int num_threads;
+static int evolution_mode = LIFEGAME_GRID;
+
+/* first word of row y of grid g */
+#define ROW(g, y) ((g) + ((size_t)(y) + 1) * stride + 1)
+
+static void allocate_world(int w, int h) {
+	size_t i;
+
+	if (w <= 0 || h <= 0) {
+		fprintf(stderr,"Error: world size %dx%d is invalid.\n", w, h);
+		abort();
+	}
+	for (i = 0; i < 2; i++) {
+		free(grids[i]);
+		grids[i] = NULL;
+	}
+
+	width = w;
+	height = h;
+	words = ((size_t)w + 63) / 64;
+	stride = words + 2;
+	lastmask = w % 64 ? ((uint64_t)1 << (w % 64)) - 1 : ~(uint64_t)0;
+	for (i = 0; i < 2; i++) {
+		if (posix_memalign((void **)&grids[i], 64,
+				((size_t)h + 2) * stride * sizeof(uint64_t)) != 0) {
+			fprintf(stderr,"Error: out of memory for a %dx%d world.\n", w, h);
+			abort();
+		}
+		memset(grids[i], 0, ((size_t)h + 2) * stride * sizeof(uint64_t));
+	}
+	cur = 0;
+}
+
+static void ensure_world(void) {
+	if (grids[0] == NULL)
+		allocate_world(WORLDWIDTH, WORLDHEIGHT);
+}
+
+static void clear_grid(uint64_t *g) {
+	memset(g, 0, ((size_t)height + 2) * stride * sizeof(uint64_t));
+}
+
+static void set_bit(uint64_t *g, int x, int y, int state) {
+	uint64_t bit = (uint64_t)1 << (x & 63);
+
+	if (state == ALIVE)
+		ROW(g, y)[x >> 6] |= bit;
+	else
+		ROW(g, y)[x >> 6] &= ~bit;
+}
+
+/* functions to write for Part B of lab */
+void initialize_world_from_file(const char * filename) {
+	/* the ith character of the jth line describes cell (i,j); short lines
+	   and missing lines are DEAD, extra characters and lines are ignored */
+	FILE * pfile;
+	int i, j = 0, ch;
+	size_t len;
+	char *strread;
+
+	ensure_world();
+	if ((pfile = fopen(filename, "r")) == NULL) {
+		fprintf(stderr,"Error: unable to read \"%s\" (error #%d).\n",
+				filename, errno);
+		abort();
+	}
+	if ((strread = malloc((size_t)width + 2)) == NULL) {
+		fprintf(stderr,"Error: out of memory reading \"%s\".\n", filename);
+		abort();
+	}
+
+	clear_grid(grids[0]);
+	clear_grid(grids[1]);
+	cur = 0;
+
+	while (j < height && fgets(strread, width + 2, pfile) != NULL) {
+		len = strlen(strread);
+		if (len > 0 && strread[len-1] != '\n')
+			while ((ch = getc(pfile)) != EOF && ch != '\n')
+				; /* skip the rest of a long line */
+		if (len > (size_t)width)
+			len = width;
+		for (i = 0; i < (int)len; i++)
+			if (strread[i] == CHAR_ALIVE)
+				set_bit(grids[cur], i, j, ALIVE);
+		j++;
+	}
+
+	free(strread);
+	fclose(pfile);
+}
+
+void save_world_to_file(const char * filename) {
+	FILE * pfile;
+	int i, j;
+	const uint64_t *row;
+	char *strwrite;
+
+	ensure_world();
+	if ((pfile = fopen(filename, "w")) == NULL) {
+		fprintf(stderr,"Error: unable to open \"%s\" for writing (error #%d).\n",
+				filename, errno);
+		abort();
+	}
+	if ((strwrite = malloc((size_t)width + 1)) == NULL) {
+		fprintf(stderr,"Error: out of memory writing \"%s\".\n", filename);
+		abort();
+	}
+
+	strwrite[width] = '\n';
+	for (j = 0; j < height; j++) {
+		row = ROW(grids[cur], j);
+		for (i = 0; i < width; i++)
+			strwrite[i] = (row[i >> 6] >> (i & 63)) & 1 ? CHAR_ALIVE : CHAR_DEAD;
+		fwrite(strwrite, 1, (size_t)width + 1, pfile);
+	}
+
+	free(strwrite);
+	fclose(pfile);
+}
+
+/* initializes the world to a hard-coded pattern, and resets
+   all the cells in the next generation to DEAD */
+void initialize_world(void) {
+	ensure_world();
+	clear_grid(grids[0]);
+	clear_grid(grids[1]);
+	cur = 0;
+	/* pattern "glider" */
+	set_cell_state(1, 2, ALIVE);
+	set_cell_state(3, 1, ALIVE);
+	set_cell_state(3, 2, ALIVE);
+	set_cell_state(3, 3, ALIVE);
+	set_cell_state(2, 3, ALIVE);
+	finalize_evolution();
+}
+
+int get_world_width(void) {
+	ensure_world();
+	return width;
+}
+
+int get_world_height(void) {
+	ensure_world();
+	return height;
+}
+
+int get_cell_state(int x, int y) {
+	ensure_world();
+	if (x < 0 || x >= width || y < 0 || y >= height)
+		return DEAD;
+	return (ROW(grids[cur], y)[x >> 6] >> (x & 63)) & 1;
+}
+
+void set_cell_state(int x, int y, int state) {
+	ensure_world();
+	if (x < 0 || x >= width || y < 0 || y >= height) {
+		fprintf(stderr,"Error: coordinates (%d,%d) are invalid.\n",
+				x, y);
+		abort();
+	}
+	set_bit(grids[!cur], x, y, state);
+}
+
+void finalize_evolution(void) {
+	ensure_world();
+	cur = !cur;
+	clear_grid(grids[!cur]);
+}
+
+void output_world(void) {
+	char *worldstr;
+	int i, j;
+
+	ensure_world();
+	if ((worldstr = malloc(2 * (size_t)width + 2)) == NULL) {
+		fprintf(stderr,"Error: out of memory.\n");
+		abort();
+	}
+
+	worldstr[2*width+1] = '\0';
+	worldstr[0] = '+';
+	for (i = 1; i < 2*width; i++)
+		worldstr[i] = '-';
+	worldstr[2*width] = '+';
+	puts(worldstr);
+	for (i = 0; i <= 2*width; i+=2)
+		worldstr[i] = '|';
+	for (i = 0; i < height; i++) {
+		for (j = 0; j < width; j++)
+			worldstr[2*j+1] = get_cell_state(j, i) == ALIVE ? CHAR_ALIVE : CHAR_DEAD;
+		puts(worldstr);
+	}
+	worldstr[0] = '+';
+	for (i = 1; i < 2*width; i++)
+		worldstr[i] = '-';
+	worldstr[2*width] = '+';
+	puts(worldstr);
+	free(worldstr);
+}
+
+/* extensions (lifegame_ext.h) */
+
+void set_world_size(int w, int h) {
+	allocate_world(w, h);
+}
+
+void set_num_threads(int threads) {
+	num_threads = threads > 0 ? threads : 0;
+}
+
+void set_evolution_mode(int mode) {
+	if (mode != LIFEGAME_GRID && mode != LIFEGAME_HASHLIFE) {
+		fprintf(stderr,"Error: evolution mode %d is invalid.\n", mode);
+		abort();
+	}
+	evolution_mode = mode;
+}
+
+long count_live_cells(void) {
+	long n = 0;
+	size_t i;
+	int y;
+
+	ensure_world();
+	for (y = 0; y < height; y++)
+		for (i = 0; i < words; i++)
+			n += __builtin_popcountll(ROW(grids[cur], y)[i]);
+	return n;
+}
+
+/* computes rows y0..y1-1 of the generation after src into dst.
+
+   For each word, the eight neighbour bitboards are the rows above (a),
+   below (b) and the current row (c), each shifted one cell west and east
+   with the carry taken from the adjacent word. They are summed with
+   bitwise full adders: a and b give 0..3 each as two bits, c's two
+   neighbours give 0..2. A cell lives next generation iff its count is 3,
+   or 2 and it is alive now; with the count written as s0 + 2*t, that is
+   t == 1 and (s0 or alive). */
+static void step_band(const uint64_t *src, uint64_t *dst, int y0, int y1) {
+	const size_t n = words;
+	const uint64_t mask = lastmask;
+	int y;
+	size_t i;
+
+	for (y = y0; y < y1; y++) {
+		const uint64_t *a = ROW(src, y - 1), *c = ROW(src, y), *b = ROW(src, y + 1);
+		uint64_t *out = ROW(dst, y);
+
+		for (i = 0; i < n; i++) {
+			uint64_t aw = (a[i] << 1) | (a[i-1] >> 63), ae = (a[i] >> 1) | (a[i+1] << 63);
+			uint64_t bw = (b[i] << 1) | (b[i-1] >> 63), be = (b[i] >> 1) | (b[i+1] << 63);
+			uint64_t cw = (c[i] << 1) | (c[i-1] >> 63), ce = (c[i] >> 1) | (c[i+1] << 63);
+
+			uint64_t a0 = aw ^ a[i] ^ ae, a1 = (aw & a[i]) | (ae & (aw ^ a[i]));
+			uint64_t b0 = bw ^ b[i] ^ be, b1 = (bw & b[i]) | (be & (bw ^ b[i]));
+			uint64_t c0 = cw ^ ce, c1 = cw & ce;
+
+			/* ones digit of the count, and its carry into the twos */
+			uint64_t s0 = a0 ^ b0 ^ c0, k = (a0 & b0) | (c0 & (a0 ^ b0));
+			/* t == 1 iff exactly one of a1, b1, c1, k is set */
+			uint64_t p = a1 ^ b1, r = c1 ^ k;
+			uint64_t one = (p ^ r) & ~((a1 & b1) | (c1 & k) | (p & r));
+
+			out[i] = one & (s0 | c[i]);
+		}
+		out[n-1] &= mask; /* cells past the edge stay DEAD */
+	}
+}
+
+struct band {
+	int y0, y1;
+	long generations;
+	pthread_barrier_t *barrier;
+};
+
+static void *band_worker(void *arg) {
+	const struct band *band = arg;
+	long g;
+
+	for (g = 0; g < band->generations; g++) {
+		step_band(grids[(cur + g) & 1], grids[(cur + g + 1) & 1],
+				band->y0, band->y1);
+		pthread_barrier_wait(band->barrier);
+	}
+	return NULL;
+}
+
+static void evolve_grid(long generations) {
+	int threads = num_threads, t;
+	long g;
+	pthread_t *tids;
+	struct band *bands;
+	pthread_barrier_t barrier;
+
+	if (threads == 0)
+		threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (threads > height / MIN_BAND_ROWS)
+		threads = height / MIN_BAND_ROWS;
+
+	if (threads <= 1) {
+		for (g = 0; g < generations; g++)
+			step_band(grids[(cur + g) & 1], grids[(cur + g + 1) & 1], 0, height);
+		return;
+	}
+
+	tids = malloc(threads * sizeof(*tids));
+	bands = malloc(threads * sizeof(*bands));
+	if (tids == NULL || bands == NULL) {
+		fprintf(stderr,"Error: out of memory.\n");
+		abort();
+	}
+	pthread_barrier_init(&barrier, NULL, threads);
+	for (t = 0; t < threads; t++) {
+		bands[t].y0 = (int)((long)height * t / threads);
+		bands[t].y1 = (int)((long)height * (t + 1) / threads);
+		bands[t].generations = generations;
+		bands[t].barrier = &barrier;
+	}
+	/* this thread steps band 0 */
+	for (t = 1; t < threads; t++)
+		if (pthread_create(&tids[t], NULL, band_worker, &bands[t]) != 0) {
+			fprintf(stderr,"Error: unable to create thread (error #%d).\n", errno);
+			abort();
+		}
+	band_worker(&bands[0]);
+	for (t = 1; t < threads; t++)
+		pthread_join(tids[t], NULL);
+
+	pthread_barrier_destroy(&barrier);
+	free(bands);
+	free(tids);
+}
+
+void evolve_world(long generations) {
+	ensure_world();
+	if (generations <= 0)
+		return;
+
+	if (evolution_mode == LIFEGAME_HASHLIFE) {
+		hashlife_evolve(ROW(grids[cur], 0), width, height, stride, generations);
+	} else {
+		evolve_grid(generations);
+		cur = (int)((cur + generations) & 1);
+	}
+	clear_grid(grids[!cur]);
+}
@@ -0,0 +1,140 @@
+/*
+ * lifegame_bench.c
+ *
+ *  Checks evolve_world() against the cell-by-cell rules of Part A and
+ *  measures generations per second.
+ *
+ *  Build:  gcc -O3 -march=native -pthread -o lifegame_bench lifegame_bench.c lifegame.c hashlife.c
+ *  Usage:  lifegame_bench [-s WIDTHxHEIGHT] [-g generations] [-t threads]
+ *                         [-d density] [-m grid|hashlife] [-c check-generations]
+ *                         [pattern.txt]
+ *
+ *  Examples:
+ *    lifegame_bench -s 10000x10000 -g 100          random 10^4 x 10^4 soup
+ *    lifegame_bench -s 4096x4096 -m hashlife -g 1000 glider.txt
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lifegame.h"
+#include "lifegame_ext.h"
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* one generation through the lifegame.h interface, as in lab1b.c */
+static void next_generation(void) {
+	int x, y, dx, dy, n, lenx = get_world_width(), leny = get_world_height();
+
+	for (x = 0; x < lenx; x++)
+		for (y = 0; y < leny; y++) {
+			n = 0;
+			for (dx = -1; dx <= 1; dx++)
+				for (dy = -1; dy <= 1; dy++)
+					if ((dx || dy) && get_cell_state(x + dx, y + dy) == ALIVE)
+						n++;
+			set_cell_state(x, y, n == 3 || (n == 2 && get_cell_state(x, y) == ALIVE)
+					? ALIVE : DEAD);
+		}
+	finalize_evolution();
+}
+
+static char *snapshot(void) {
+	int x, y, w = get_world_width(), h = get_world_height();
+	char *cells = malloc((size_t)w * h);
+
+	if (cells == NULL) {
+		fprintf(stderr,"Error: out of memory.\n");
+		abort();
+	}
+	for (y = 0; y < h; y++)
+		for (x = 0; x < w; x++)
+			cells[(size_t)y * w + x] = (char)get_cell_state(x, y);
+	return cells;
+}
+
+static void restore(const char *cells) {
+	int x, y, w = get_world_width(), h = get_world_height();
+
+	for (y = 0; y < h; y++)
+		for (x = 0; x < w; x++)
+			set_cell_state(x, y, cells[(size_t)y * w + x]);
+	finalize_evolution();
+}
+
+int main(int argc, char ** argv) {
+	int width = 39, height = 20, threads = 0, mode = LIFEGAME_GRID, i, x, y;
+	long generations = 100, check = 0;
+	double density = 0.3, t;
+	const char *pattern = NULL;
+	char *start, *expected, *actual;
+
+	for (i = 1; i < argc; i++) {
+		if (argv[i][0] == '-' && i + 1 < argc) {
+			switch (argv[i][1]) {
+			case 's': sscanf(argv[++i], "%dx%d", &width, &height); break;
+			case 'g': generations = atol(argv[++i]); break;
+			case 't': threads = atoi(argv[++i]); break;
+			case 'd': density = atof(argv[++i]); break;
+			case 'c': check = atol(argv[++i]); break;
+			case 'm': mode = strcmp(argv[++i], "hashlife") == 0
+					? LIFEGAME_HASHLIFE : LIFEGAME_GRID; break;
+			default: fprintf(stderr,"Error: unknown option %s.\n", argv[i]); return 2;
+			}
+		} else if (argv[i][0] != '-') {
+			pattern = argv[i];
+		} else {
+			fprintf(stderr,"Error: option %s needs a value.\n", argv[i]);
+			return 2;
+		}
+	}
+
+	set_world_size(width, height);
+	set_num_threads(threads);
+	set_evolution_mode(mode);
+	if (pattern != NULL) {
+		initialize_world_from_file(pattern);
+	} else {
+		srand(1);
+		for (y = 0; y < height; y++)
+			for (x = 0; x < width; x++)
+				if (rand() < density * RAND_MAX)
+					set_cell_state(x, y, ALIVE);
+		finalize_evolution();
+	}
+	printf("%dx%d world, %ld live cells, %s mode\n", width, height,
+			count_live_cells(), mode == LIFEGAME_HASHLIFE ? "hashlife" : "grid");
+
+	if (check > 0) {
+		start = snapshot();
+		for (i = 0; i < check; i++)
+			next_generation();
+		expected = snapshot();
+		restore(start);
+		evolve_world(check);
+		actual = snapshot();
+		if (memcmp(expected, actual, (size_t)width * height) != 0) {
+			printf("check FAILED after %ld generations\n", check);
+			return 1;
+		}
+		printf("check passed: %ld generations match lifegame.h cell by cell\n", check);
+		restore(start);
+		free(start);
+		free(expected);
+		free(actual);
+	}
+
+	t = now();
+	evolve_world(generations);
+	t = now() - t;
+	printf("%ld generations in %.3f s: %.1f generations/s, %.2f Gcell updates/s, "
+			"%ld live cells\n", generations, t, generations / t,
+			(double)width * height * generations / t * 1e-9, count_live_cells());
+	return 0;
+}
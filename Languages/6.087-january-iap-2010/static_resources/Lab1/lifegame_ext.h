@@ -0,0 +1,43 @@
+/*
+ * lifegame_ext.h
+ *
+ *  Extensions to lifegame.h for large worlds: world size, whole-world
+ *  evolution in bulk, threads and the HashLife mode.
+ */
+
+/* lifegame.h is left as distributed; programs written against it work
+   unchanged. Include this header as well to use the bulk interface. */
+
+#ifndef LIFEGAME_EXT_H_
+#define LIFEGAME_EXT_H_
+
+/* evolution modes for evolve_world() */
+#define LIFEGAME_GRID 0     /* bit-packed grid; cells outside the world are
+                               DEAD, exactly as with finalize_evolution() */
+#define LIFEGAME_HASHLIFE 1 /* memoized quadtree on an unbounded plane;
+                               fast for sparse patterns over many generations.
+                               Agrees with LIFEGAME_GRID while the pattern stays
+                               clear of the world edges; cells that leave the
+                               world are dropped */
+
+/* resizes the world to width x height cells, all DEAD; the default is 39x20,
+   the size of the original lab. Calls abort() on invalid sizes or if memory
+   runs out */
+void set_world_size(int width, int height);
+
+/* number of threads evolve_world() uses in LIFEGAME_GRID mode;
+   0 (the default) means one per online processor */
+void set_num_threads(int threads);
+
+/* selects LIFEGAME_GRID (the default) or LIFEGAME_HASHLIFE */
+void set_evolution_mode(int mode);
+
+/* advances the world by the given number of generations according to the
+   rules of Conway's Game of Life; any states already set with
+   set_cell_state() are discarded, and the next generation is left DEAD */
+void evolve_world(long generations);
+
+/* returns the number of ALIVE cells in the world */
+long count_live_cells(void);
+
+#endif /* LIFEGAME_EXT_H_ */
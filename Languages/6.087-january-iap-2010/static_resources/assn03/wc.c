@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "wccount.h"
+
+/*
+  wc [-j threads] [-b bytes] [-g] [-t] [file ...]
+
+  Prints "lines words characters name" for each file, then a total if
+  there is more than one; reads standard input if no files are given.
+  Files are counted in parallel by a pool of threads (-j, default one per
+  processor) and printed in command-line order as soon as each is ready.
+
+  -b  read files in pieces of this many bytes instead of mapping them
+  -g  count with the original getc() loop, for comparison
+  -t  print the elapsed time and throughput on stderr
+
+  Build: gcc -O2 -march=native -pthread -o wc wc.c wccount.c
+*/
+
+struct job
+{
+    const char* name;
+    struct wcstate st;
+    int err;  /* errno value, 0 on success */
+    int done;
+};
+
+static struct job* jobs;
+static int njobs,nextjob;
+static size_t chunk;
+static int use_getc;
+static pthread_mutex_t lock=PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t finished=PTHREAD_COND_INITIALIZER;
+
+/*
+  @function count
+  @desc     counts one file into job->st
+*/
+static void count(struct job* job)
+{
+    wc_init(&job->st);
+    if(use_getc)
+    {
+        FILE* fp=fopen(job->name,"rb");
+        if(fp==NULL)
+        {
+            job->err=errno;
+            return;
+        }
+        wc_update_getc(&job->st,fp);
+        if(ferror(fp))
+            job->err=EIO;
+        fclose(fp);
+    }
+    else
+    {
+        int fd=open(job->name,O_RDONLY);
+        if(fd<0)
+        {
+            job->err=errno;
+            return;
+        }
+        job->err=wc_fd(fd,&job->st,chunk);
+        close(fd);
+    }
+}
+
+static void* worker(void* arg)
+{
+    int i;
+    (void)arg;
+    for(;;)
+    {
+        pthread_mutex_lock(&lock);
+        i=nextjob++;
+        pthread_mutex_unlock(&lock);
+        if(i>=njobs)
+            return NULL;
+        count(&jobs[i]);
+        pthread_mutex_lock(&lock);
+        jobs[i].done=1;
+        pthread_cond_broadcast(&finished);
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+int main(int argc,char* argv[])
+{
+    int nthreads=(int)sysconf(_SC_NPROCESSORS_ONLN),timing=0,status=0,i,argidx;
+    pthread_t* tids;
+    struct wcstate total;
+    double start=now(),elapsed;
+
+    for(argidx=1;argidx<argc && argv[argidx][0]=='-' && argv[argidx][1];argidx++)
+    {
+        if(strcmp(argv[argidx],"-j")==0 && argidx+1<argc)
+            nthreads=atoi(argv[++argidx]);
+        else if(strcmp(argv[argidx],"-b")==0 && argidx+1<argc)
+            chunk=(size_t)strtoul(argv[++argidx],NULL,10);
+        else if(strcmp(argv[argidx],"-g")==0)
+            use_getc=1;
+        else if(strcmp(argv[argidx],"-t")==0)
+            timing=1;
+        else
+        {
+            fprintf(stderr,"usage: wc [-j threads] [-b bytes] [-g] [-t] [file ...]\n");
+            return 2;
+        }
+    }
+    wc_init(&total);
+
+    njobs=argc-argidx;
+    if(njobs==0) /*standard input*/
+    {
+        int err;
+        if(use_getc)
+        {
+            wc_update_getc(&total,stdin);
+            err=ferror(stdin)?EIO:0;
+        }
+        else
+            err=wc_fd(0,&total,chunk);
+        if(err)
+        {
+            fprintf(stderr,"wc: standard input: %s\n",strerror(err));
+            return 1;
+        }
+        printf("%lu %lu %lu\n",total.nl,total.nw,total.nc);
+        return 0;
+    }
+
+    jobs=(struct job*)calloc(njobs,sizeof(struct job));
+    if(nthreads<1)
+        nthreads=1;
+    if(nthreads>njobs)
+        nthreads=njobs;
+    tids=(pthread_t*)calloc(nthreads,sizeof(pthread_t));
+    if(jobs==NULL || tids==NULL)
+    {
+        fprintf(stderr,"wc: out of memory\n");
+        return 1;
+    }
+    for(i=0;i<njobs;i++)
+        jobs[i].name=argv[argidx+i];
+    for(i=0;i<nthreads;i++)
+        if(pthread_create(&tids[i],NULL,worker,NULL)!=0)
+            break;
+    if(i==0) /*no threads: count here*/
+        worker(NULL);
+    nthreads=i;
+
+    /*print in order, each file as soon as it and those before it are done*/
+    for(i=0;i<njobs;i++)
+    {
+        pthread_mutex_lock(&lock);
+        while(!jobs[i].done)
+            pthread_cond_wait(&finished,&lock);
+        pthread_mutex_unlock(&lock);
+        if(jobs[i].err)
+        {
+            fprintf(stderr,"wc: %s: %s\n",jobs[i].name,strerror(jobs[i].err));
+            status=1;
+            continue;
+        }
+        printf("%lu %lu %lu %s\n",jobs[i].st.nl,jobs[i].st.nw,jobs[i].st.nc,jobs[i].name);
+        total.nl+=jobs[i].st.nl;
+        total.nw+=jobs[i].st.nw;
+        total.nc+=jobs[i].st.nc;
+    }
+    if(njobs>1)
+        printf("%lu %lu %lu total\n",total.nl,total.nw,total.nc);
+    for(i=0;i<nthreads;i++)
+        pthread_join(tids[i],NULL);
+
+    if(timing)
+    {
+        elapsed=now()-start;
+        fprintf(stderr,"%.3f s, %.2f GB/s\n",elapsed,total.nc/elapsed/1e9);
+    }
+    free(tids);
+    free(jobs);
+    return status;
+}
@@ -0,0 +1,174 @@
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "wccount.h"
+
+#define IS_SPACE(c) ((c)==' ' || ((c)>='\t' && (c)<='\r'))
+
+void wc_init(struct wcstate* st)
+{
+    memset(st,0,sizeof(*st));
+}
+
+/*
+  @function classify64
+  @desc     sets bit i of *space if p[i] is whitespace and bit i of *newline
+            if p[i] is '\n', for i=0..63. Whitespace is ' ' or a byte b with
+            b-9 <= 4 unsigned ('\t'..'\r'), tested as min(b-9,4)==b-9
+*/
+#if defined(__AVX2__)
+static uint32_t spaces32(__m256i v)
+{
+    __m256i t  =_mm256_sub_epi8(v,_mm256_set1_epi8(9));
+    __m256i ctl=_mm256_cmpeq_epi8(_mm256_min_epu8(t,_mm256_set1_epi8(4)),t);
+    __m256i sp =_mm256_cmpeq_epi8(v,_mm256_set1_epi8(' '));
+    return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(ctl,sp));
+}
+
+static void classify64(const unsigned char* p,uint64_t* space,uint64_t* newline)
+{
+    __m256i lo=_mm256_loadu_si256((const __m256i*)p);
+    __m256i hi=_mm256_loadu_si256((const __m256i*)(p+32));
+    __m256i nl=_mm256_set1_epi8('\n');
+    *space  =spaces32(lo)|(uint64_t)spaces32(hi)<<32;
+    *newline=(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo,nl))|
+             (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi,nl))<<32;
+}
+#elif defined(__SSE2__)
+static uint64_t spaces16(__m128i v)
+{
+    __m128i t  =_mm_sub_epi8(v,_mm_set1_epi8(9));
+    __m128i ctl=_mm_cmpeq_epi8(_mm_min_epu8(t,_mm_set1_epi8(4)),t);
+    __m128i sp =_mm_cmpeq_epi8(v,_mm_set1_epi8(' '));
+    return (uint64_t)_mm_movemask_epi8(_mm_or_si128(ctl,sp));
+}
+
+static void classify64(const unsigned char* p,uint64_t* space,uint64_t* newline)
+{
+    __m128i nl=_mm_set1_epi8('\n');
+    int i;
+    *space=*newline=0;
+    for(i=0;i<4;i++)
+    {
+        __m128i v=_mm_loadu_si128((const __m128i*)(p+16*i));
+        *space  |=spaces16(v)<<(16*i);
+        *newline|=(uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v,nl))<<(16*i);
+    }
+}
+#else
+static void classify64(const unsigned char* p,uint64_t* space,uint64_t* newline)
+{
+    int i;
+    *space=*newline=0;
+    for(i=0;i<64;i++)
+    {
+        *space  |=(uint64_t)IS_SPACE(p[i])<<i;
+        *newline|=(uint64_t)(p[i]=='\n')<<i;
+    }
+}
+#endif
+
+void wc_update(struct wcstate* st,const unsigned char* buf,size_t len)
+{
+    /* bit 0 of prev: the byte before the current block was whitespace */
+    uint64_t prev=!st->inword,space,newline;
+    unsigned long nl=0,nw=0;
+    size_t i;
+
+    st->nc+=len;
+    for(;len>=64;buf+=64,len-=64)
+    {
+        classify64(buf,&space,&newline);
+        /* a word starts at each non-space byte that follows a space */
+        nw+=__builtin_popcountll(~space&(space<<1|prev));
+        nl+=__builtin_popcountll(newline);
+        prev=space>>63;
+    }
+    st->inword=!prev;
+    for(i=0;i<len;i++)
+    {
+        if(buf[i]=='\n')
+            nl++;
+        if(IS_SPACE(buf[i]))
+            st->inword=0;
+        else if(!st->inword)
+        {
+            st->inword=1;
+            nw++;
+        }
+    }
+    st->nl+=nl;
+    st->nw+=nw;
+}
+
+void wc_update_getc(struct wcstate* st,FILE* fp)
+{
+    int c; /* int, not char, so a 0xFF byte is not mistaken for EOF */
+    while((c=getc(fp))!=EOF)
+    {
+        st->nc++;
+        if(c=='\n')
+            st->nl++;
+        if(IS_SPACE(c))
+            st->inword=0;
+        else if(!st->inword)
+        {
+            st->inword=1;
+            st->nw++;
+        }
+    }
+}
+
+int wc_fd(int fd,struct wcstate* st,size_t chunk)
+{
+    struct stat sb;
+    unsigned char* buf=NULL;
+    ssize_t n;
+
+    /*size 0 may be a pseudo-file (/proc) with content: read() it*/
+    if(chunk==0 && fstat(fd,&sb)==0 && S_ISREG(sb.st_mode) &&
+       sb.st_size>0 && (uint64_t)sb.st_size<=SIZE_MAX)
+    {
+        void* p=mmap(NULL,(size_t)sb.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+        if(p!=MAP_FAILED)
+        {
+            madvise(p,(size_t)sb.st_size,MADV_SEQUENTIAL);
+            wc_update(st,(const unsigned char*)p,(size_t)sb.st_size);
+            munmap(p,(size_t)sb.st_size);
+            return 0;
+        }
+        /* not mappable: fall back to read() */
+    }
+
+    if(chunk==0)
+        chunk=WC_CHUNK;
+    if(posix_memalign((void**)&buf,64,chunk)!=0)
+        return ENOMEM;
+    for(;;)
+    {
+        n=read(fd,buf,chunk);
+        if(n>0)
+            wc_update(st,buf,(size_t)n);
+        else if(n==0)
+            break;
+        else if(errno!=EINTR)
+        {
+            int err=errno;
+            free(buf);
+            return err;
+        }
+    }
+    free(buf);
+    return 0;
+}
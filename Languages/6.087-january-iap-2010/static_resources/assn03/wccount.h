@@ -0,0 +1,54 @@
+#ifndef WCCOUNT_H
+#define WCCOUNT_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+  Line, word and character counting for wc.c.
+
+  A word is a run of characters other than the C-locale whitespace
+  (' ', '\t', '\n', '\v', '\f', '\r'); characters are bytes. Counting is
+  incremental: feed a file through wc_update() in pieces of any size and
+  the counts match one pass over the whole file, since inword carries
+  "the last byte was part of a word" across piece boundaries.
+*/
+struct wcstate
+{
+    unsigned long nl,nw,nc;
+    int inword;
+};
+
+#define WC_CHUNK (1<<20) /* read() size when a file cannot be mapped */
+
+/*
+  @function wc_init
+  @desc     zeroes the counts
+*/
+void wc_init(struct wcstate* st);
+
+/*
+  @function wc_update
+  @desc     counts len bytes of buf, 64 at a time with AVX2 or SSE2 where
+            available, continuing from the state left by earlier calls
+*/
+void wc_update(struct wcstate* st,const unsigned char* buf,size_t len);
+
+/*
+  @function wc_update_getc
+  @desc     the one-character-at-a-time loop of the original wc.c, kept as
+            the reference and for comparison
+*/
+void wc_update_getc(struct wcstate* st,FILE* fp);
+
+/*
+  @function wc_fd
+  @desc     counts everything readable from fd. Non-empty regular files
+            are mapped into memory unless chunk is nonzero; otherwise the
+            file (including size-0 pseudo-files such as /proc) is read
+            in chunk-byte pieces (WC_CHUNK if chunk is 0). Returns 0, or an
+            errno value on failure
+*/
+int wc_fd(int fd,struct wcstate* st,size_t chunk);
+
+#endif
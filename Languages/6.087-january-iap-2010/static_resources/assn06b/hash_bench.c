@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "wordtable.h"
+
+/*
+  Word-count throughput, in words/s, of the handout's chained table
+  against wordtable.c, single-threaded and sharded. All three must agree
+  on every count.
+
+  Build: gcc -O2 -pthread -o hash_bench hash_bench.c wordtable.c
+  Usage: hash_bench [-r repeat] [-t threads] [file ...]   (default book.txt)
+         -r concatenates the input with itself to make a larger text
+*/
+
+#define IS_SPACE(c) ((c)==' ' || ((c)>='\t' && (c)<='\r'))
+
+/*
+  The chained table from hash_ps.c as handed out, with the TODOs filled
+  in: MAX_BUCKETS lists, malloc+strdup per new word, multiplier-31 hash
+*/
+#define MAX_BUCKETS 1000
+#define MULTIPLIER 31
+
+struct wordrec
+{
+  char* word;
+  unsigned long count;
+  struct wordrec* next;
+};
+
+struct wordrec* table[MAX_BUCKETS];
+
+struct wordrec* walloc(const char* str)
+{
+  struct wordrec* p=(struct wordrec*)malloc(sizeof(struct wordrec));
+  if(p!=NULL)
+  {
+      p->count=0;
+      p->word=strdup(str);
+      p->next=NULL;
+  }
+  return p;
+}
+
+unsigned long hashstring(const char* str)
+{
+  unsigned long hash=0;
+  while(*str)
+    {
+      hash= hash*MULTIPLIER+*str;
+      str++;
+    }
+  return hash%MAX_BUCKETS;
+}
+
+struct wordrec* lookup(const char* str,int create)
+{
+  unsigned long hash=hashstring(str);
+  struct wordrec* wp=table[hash];
+  struct wordrec* curr=NULL;
+  for(;wp!=NULL;wp=wp->next)
+    if(strcmp(wp->word,str)==0)
+      return wp;
+  if(create)
+    {
+      curr=walloc(str);
+      curr->next=table[hash];
+      table[hash]=curr;
+    }
+  return curr;
+}
+
+void cleartable()
+{
+  struct wordrec* wp=NULL,*p=NULL;
+  int i=0;
+  for(i=0;i<MAX_BUCKETS;i++)
+    {
+      for(wp=table[i];wp!=NULL;wp=p)
+        {
+          p=wp->next;
+          free(wp->word);
+          free(wp);
+        }
+      table[i]=NULL;
+    }
+}
+
+/*
+  @function count_chained
+  @desc     counts buf's words into table[], copying each word out as
+            fscanf("%s") would
+*/
+long count_chained(const char* buf,size_t len)
+{
+  const char* p=buf,*end=buf+len,*start;
+  char word[1024];
+  long n=0;
+  while(p<end)
+    {
+      while(p<end && IS_SPACE(*p))
+        p++;
+      start=p;
+      while(p<end && !IS_SPACE(*p))
+        p++;
+      if(p>start)
+        {
+          size_t l=p-start<(long)sizeof(word)?(size_t)(p-start):sizeof(word)-1;
+          memcpy(word,start,l);
+          word[l]='\0';
+          lookup(word,1)->count++;
+          n++;
+        }
+    }
+  return n;
+}
+
+double now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+/*
+  @function appendfile
+  @desc     appends a file to *buf, separated by a newline; returns 0, or
+            -1 if the file cannot be read or memory runs out
+*/
+int appendfile(const char* fname,char** buf,size_t* len)
+{
+  FILE* fp=fopen(fname,"rb");
+  char chunk[65536];
+  char* p;
+  size_t n;
+  if(fp==NULL)
+    return -1;
+  do
+    {
+      n=fread(chunk,1,sizeof(chunk),fp);
+      /*always room for the separator, even for an empty file*/
+      p=(char*)realloc(*buf,*len+n+1);
+      if(p==NULL)
+        {
+          fclose(fp);
+          return -1;
+        }
+      *buf=p;
+      memcpy(*buf+*len,chunk,n);
+      *len+=n;
+    }
+  while(n>0);
+  (*buf)[(*len)++]='\n';
+  fclose(fp);
+  return 0;
+}
+
+/* number of words in table[] whose count differs in wt */
+long mismatches(struct wordtable* wt)
+{
+  long bad=0;
+  int i;
+  struct wordrec* wp;
+  struct wordentry* e;
+  for(i=0;i<MAX_BUCKETS;i++)
+    for(wp=table[i];wp!=NULL;wp=wp->next)
+      {
+        e=wt_lookup(wt,wp->word,strlen(wp->word),0);
+        if(e==NULL || e->count!=wp->count)
+          bad++;
+      }
+  return bad;
+}
+
+int main(int argc,char* argv[])
+{
+  int repeat=1,threads=(int)sysconf(_SC_NPROCESSORS_ONLN),i,nfiles=0;
+  char* text=NULL,*buf;
+  size_t textlen=0,len;
+  long nchained,nsingle,nsharded,chained_words=0,bad;
+  double t,tchained,tsingle,tsharded;
+  struct wordtable* single,*sharded;
+
+  for(i=1;i<argc;i++)
+    {
+      if(strcmp(argv[i],"-r")==0 && i+1<argc)
+        repeat=atoi(argv[++i]);
+      else if(strcmp(argv[i],"-t")==0 && i+1<argc)
+        threads=atoi(argv[++i]);
+      else if(appendfile(argv[i],&text,&textlen)!=0)
+        {
+          fprintf(stderr,"cannot read %s\n",argv[i]);
+          return 1;
+        }
+      else
+        nfiles++;
+    }
+  if(nfiles==0 && appendfile("book.txt",&text,&textlen)!=0)
+    {
+      fprintf(stderr,"cannot read book.txt\n");
+      return 1;
+    }
+  if(repeat<1)
+    repeat=1;
+  len=textlen*repeat;
+  buf=(char*)malloc(len);
+  if(buf==NULL)
+    {
+      fprintf(stderr,"out of memory\n");
+      return 1;
+    }
+  for(i=0;i<repeat;i++)
+    memcpy(buf+textlen*i,text,textlen);
+
+  t=now();
+  nchained=count_chained(buf,len);
+  tchained=now()-t;
+  for(i=0;i<MAX_BUCKETS;i++)
+    {
+      struct wordrec* wp;
+      for(wp=table[i];wp!=NULL;wp=wp->next)
+        chained_words++;
+    }
+
+  t=now();
+  single=wt_alloc(0);
+  if(single==NULL)
+    {
+      fprintf(stderr,"out of memory\n");
+      return 1;
+    }
+  nsingle=wt_count_words(single,buf,len);
+  tsingle=now()-t;
+
+  t=now();
+  sharded=wt_count_words_sharded(buf,len,threads,&nsharded);
+  tsharded=now()-t;
+
+  if(sharded==NULL || nsingle<0)
+    {
+      fprintf(stderr,"out of memory\n");
+      return 1;
+    }
+
+  printf("%.1f MB, %ld words, %ld distinct\n",len/1e6,nchained,chained_words);
+  printf("chained, %d buckets     %8.3f s %10.2f Mwords/s\n",MAX_BUCKETS,tchained,nchained/tchained/1e6);
+  printf("open addressing         %8.3f s %10.2f Mwords/s  %.1fx\n",tsingle,nsingle/tsingle/1e6,tchained/tsingle);
+  printf("sharded, %2d threads     %8.3f s %10.2f Mwords/s  %.1fx\n",threads,tsharded,nsharded/tsharded/1e6,tchained/tsharded);
+
+  bad=mismatches(single)+mismatches(sharded);
+  if(nsingle!=nchained || nsharded!=nchained ||
+     wt_size(single)!=(size_t)chained_words || wt_size(sharded)!=(size_t)chained_words || bad)
+    {
+      printf("counts DIFFER (%ld mismatched words)\n",bad);
+      return 1;
+    }
+  printf("all counts agree\n");
+
+  cleartable();
+  wt_free(single);
+  wt_free(sharded);
+  free(buf);
+  free(text);
+  return 0;
+}
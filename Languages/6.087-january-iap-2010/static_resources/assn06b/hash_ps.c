@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wordtable.h"
+
+/*
+  Word frequencies of book.txt (from the assignment zip) or of the file
+  named on the command line.
+
+  The chained table[MAX_BUCKETS] of the handout is replaced by the
+  open-addressing table in wordtable.c; hash_bench.c compares the two.
+
+  Build: gcc -O2 -pthread -o hash_ps hash_ps.c wordtable.c
+*/
+
+#define MIN_COUNT 1000 /* print words seen more often than this */
+
+/*
+  @function readfile
+  @desc     reads a whole file into memory; returns NULL on error
+*/
+char* readfile(const char* fname,size_t* len)
+{
+  FILE* fp=fopen(fname,"rb");
+  char* buf=NULL;
+  long size;
+  if(fp==NULL)
+    return NULL;
+  if(fseek(fp,0,SEEK_END)==0 && (size=ftell(fp))>=0 && fseek(fp,0,SEEK_SET)==0)
+    {
+      buf=(char*)malloc(size>0?size:1);
+      if(buf!=NULL && fread(buf,1,size,fp)!=(size_t)size)
+        {
+          free(buf);
+          buf=NULL;
+        }
+      *len=size;
+    }
+  fclose(fp);
+  return buf;
+}
+
+/*
+  @function printfrequent
+  @desc     prints the word if its count exceeds *((unsigned long*)arg)
+*/
+void printfrequent(const struct wordentry* pent,void* arg)
+{
+  if(pent->count>*(unsigned long*)arg)
+    printf("%s-->%ld\n",pent->word,pent->count);
+}
+
+int main(int argc,char* argv[])
+{
+  const char* fname=argc>1?argv[1]:"book.txt";
+  struct wordtable* wt=NULL;
+  unsigned long mincount=MIN_COUNT;
+  size_t len=0;
+  char* buf=readfile(fname,&len);
+
+  if(buf==NULL)
+    {
+      fprintf(stderr,"cannot read %s\n",fname);
+      return 1;
+    }
+  wt=wt_alloc(0);
+  if(wt==NULL || wt_count_words(wt,buf,len)<0)
+    {
+      fprintf(stderr,"out of memory\n");
+      return 1;
+    }
+
+  /*
+    print all words have frequency>1000
+   */
+  wt_apply(wt,printfrequent,&mincount);
+  wt_free(wt);
+  free(buf);
+  return 0;
+}
@@ -0,0 +1,343 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "wordtable.h"
+
+#define MIN_SLOTS   1024
+#define BLOCK_BYTES 65536 /* arena block size */
+
+/* same characters as isspace() in the C locale, which fscanf("%s") skips */
+#define IS_SPACE(c) ((c)==' ' || ((c)>='\t' && (c)<='\r'))
+
+struct block
+{
+  struct block* next;
+  size_t used;
+  size_t size;
+  char data[];
+};
+
+struct wordtable
+{
+  struct wordentry* slots;
+  size_t mask;  /* number of slots - 1; a power of two minus one */
+  size_t size;  /* entries in use */
+  struct block* arena;
+};
+
+static uint64_t rotl(uint64_t x,int r)
+{
+  return (x<<r)|(x>>(64-r));
+}
+
+/* final avalanche from MurmurHash3 */
+static uint64_t fmix(uint64_t h)
+{
+  h^=h>>33;
+  h*=0xff51afd7ed558ccdULL;
+  h^=h>>33;
+  h*=0xc4ceb9fe1a85ec53ULL;
+  h^=h>>33;
+  return h;
+}
+
+/*
+  @function wt_hash
+  @desc     MurmurHash3-style mixing of 8-byte words. Unlike the
+            multiplier-31 hash, every input bit affects every output bit,
+            so the low bits used as a slot index are well spread
+*/
+uint64_t wt_hash(const char* str,size_t len)
+{
+  const uint64_t c1=0x87c37b91114253d5ULL,c2=0x4cf5ad432745937fULL;
+  uint64_t h=len*0x9e3779b97f4a7c15ULL,k;
+
+  for(;len>=8;str+=8,len-=8)
+    {
+      memcpy(&k,str,8);
+      h^=rotl(k*c1,31)*c2;
+      h=rotl(h,27)*5+0x52dce729;
+    }
+  if(len>0)
+    {
+      k=0;
+      memcpy(&k,str,len);
+      h^=rotl(k*c1,31)*c2;
+    }
+  return fmix(h);
+}
+
+/*
+  @function intern
+  @desc     copies str into the arena, NUL-terminated
+*/
+static const char* intern(struct wordtable* wt,const char* str,size_t len)
+{
+  struct block* b=wt->arena;
+  char* p;
+  if(b==NULL || b->size-b->used<len+1)
+    {
+      size_t size=len+1>BLOCK_BYTES?len+1:BLOCK_BYTES;
+      b=(struct block*)malloc(sizeof(struct block)+size);
+      if(b==NULL)
+        return NULL;
+      b->used=0;
+      b->size=size;
+      b->next=wt->arena;
+      wt->arena=b;
+    }
+  p=b->data+b->used;
+  memcpy(p,str,len);
+  p[len]='\0';
+  b->used+=len+1;
+  return p;
+}
+
+struct wordtable* wt_alloc(size_t nwords)
+{
+  struct wordtable* wt=(struct wordtable*)calloc(1,sizeof(struct wordtable));
+  size_t nslots=MIN_SLOTS;
+  if(wt==NULL)
+    return NULL;
+  while(nslots*4/5<nwords)
+    nslots*=2;
+  wt->slots=(struct wordentry*)calloc(nslots,sizeof(struct wordentry));
+  if(wt->slots==NULL)
+    {
+      free(wt);
+      return NULL;
+    }
+  wt->mask=nslots-1;
+  return wt;
+}
+
+void wt_free(struct wordtable* wt)
+{
+  struct block* b,*next;
+  if(wt==NULL)
+    return;
+  for(b=wt->arena;b!=NULL;b=next)
+    {
+      next=b->next;
+      free(b);
+    }
+  free(wt->slots);
+  free(wt);
+}
+
+size_t wt_size(const struct wordtable* wt)
+{
+  return wt->size;
+}
+
+/*
+  @function place
+  @desc     Robin Hood insertion of an entry known to be absent: walking
+            from its home slot, it takes the place of any entry that is
+            closer to home than it is, and that entry moves on instead.
+            Returns the slot the original entry landed in
+*/
+static struct wordentry* place(struct wordtable* wt,struct wordentry ent)
+{
+  size_t i=ent.hash&wt->mask,dist=0,d;
+  struct wordentry* landed=NULL,tmp;
+  for(;;i=(i+1)&wt->mask,dist++)
+    {
+      struct wordentry* s=&wt->slots[i];
+      if(s->word==NULL)
+        {
+          *s=ent;
+          return landed?landed:s;
+        }
+      d=(i-(s->hash&wt->mask))&wt->mask;
+      if(d<dist)
+        {
+          tmp=*s;
+          *s=ent;
+          ent=tmp;
+          if(landed==NULL)
+            landed=s;
+          dist=d;
+        }
+    }
+}
+
+static int grow(struct wordtable* wt)
+{
+  struct wordentry* old=wt->slots;
+  size_t n=wt->mask+1,i;
+  struct wordentry* slots=(struct wordentry*)calloc(2*n,sizeof(struct wordentry));
+  if(slots==NULL)
+    return -1;
+  wt->slots=slots;
+  wt->mask=2*n-1;
+  for(i=0;i<n;i++)
+    if(old[i].word!=NULL)
+      place(wt,old[i]);
+  free(old);
+  return 0;
+}
+
+static struct wordentry* find(struct wordtable* wt,const char* str,size_t len,uint64_t hash,int create)
+{
+  size_t i=hash&wt->mask,dist=0;
+  struct wordentry ent;
+  for(;;i=(i+1)&wt->mask,dist++)
+    {
+      struct wordentry* s=&wt->slots[i];
+      /* an empty slot, or an entry closer to home than we are, means absent */
+      if(s->word==NULL || ((i-(s->hash&wt->mask))&wt->mask)<dist)
+        break;
+      if(s->hash==hash && s->len==len && memcmp(s->word,str,len)==0)
+        return s;
+    }
+  if(!create)
+    return NULL;
+
+  if((wt->size+1)*5>(wt->mask+1)*4 && grow(wt)!=0)
+    return NULL;
+  ent.word=intern(wt,str,len);
+  if(ent.word==NULL)
+    return NULL;
+  ent.count=0;
+  ent.hash=hash;
+  ent.len=len;
+  wt->size++;
+  return place(wt,ent);
+}
+
+struct wordentry* wt_lookup(struct wordtable* wt,const char* str,size_t len,int create)
+{
+  return find(wt,str,len,wt_hash(str,len),create);
+}
+
+void wt_apply(const struct wordtable* wt,void (*fp)(const struct wordentry* pent,void* arg),void* arg)
+{
+  size_t i;
+  for(i=0;i<=wt->mask;i++)
+    if(wt->slots[i].word!=NULL)
+      fp(&wt->slots[i],arg);
+}
+
+int wt_merge(struct wordtable* dst,const struct wordtable* src)
+{
+  size_t i;
+  for(i=0;i<=src->mask;i++)
+    {
+      const struct wordentry* s=&src->slots[i];
+      struct wordentry* d;
+      if(s->word==NULL)
+        continue;
+      d=find(dst,s->word,s->len,s->hash,1);
+      if(d==NULL)
+        return -1;
+      d->count+=s->count;
+    }
+  return 0;
+}
+
+long wt_count_words(struct wordtable* wt,const char* buf,size_t len)
+{
+  const char* p=buf,*end=buf+len,*start;
+  struct wordentry* wp;
+  long n=0;
+  while(p<end)
+    {
+      while(p<end && IS_SPACE(*p))
+        p++;
+      start=p;
+      while(p<end && !IS_SPACE(*p))
+        p++;
+      if(p>start)
+        {
+          wp=find(wt,start,p-start,wt_hash(start,p-start),1);
+          if(wp==NULL)
+            return -1;
+          wp->count++;
+          n++;
+        }
+    }
+  return n;
+}
+
+struct shard
+{
+  const char* buf;
+  size_t len;
+  struct wordtable* wt;
+  long nwords;
+};
+
+static void* count_shard(void* arg)
+{
+  struct shard* s=(struct shard*)arg;
+  s->nwords=wt_count_words(s->wt,s->buf,s->len);
+  return NULL;
+}
+
+struct wordtable* wt_count_words_sharded(const char* buf,size_t len,int nthreads,long* nwords)
+{
+  struct shard* shards;
+  pthread_t* tids;
+  struct wordtable* result=NULL;
+  size_t pos=0,next;
+  int i,started=0,failed=0;
+
+  if(nthreads<1)
+    nthreads=1;
+  shards=(struct shard*)calloc(nthreads,sizeof(struct shard));
+  tids=(pthread_t*)calloc(nthreads,sizeof(pthread_t));
+  if(shards==NULL || tids==NULL)
+    goto done;
+
+  /* cut at whitespace so no word is split between shards */
+  for(i=0;i<nthreads;i++)
+    {
+      next=i==nthreads-1?len:len/nthreads*(i+1);
+      if(next<pos)
+        next=pos;
+      while(next<len && !IS_SPACE(buf[next]))
+        next++;
+      shards[i].buf=buf+pos;
+      shards[i].len=next-pos;
+      shards[i].wt=wt_alloc(0);
+      if(shards[i].wt==NULL)
+        goto done;
+      pos=next;
+    }
+
+  /* this thread counts shard 0 */
+  for(started=1;started<nthreads;started++)
+    if(pthread_create(&tids[started],NULL,count_shard,&shards[started])!=0)
+      break;
+  for(i=started;i<nthreads;i++)
+    count_shard(&shards[i]); /* no thread: count inline */
+  count_shard(&shards[0]);
+  for(i=1;i<started;i++)
+    pthread_join(tids[i],NULL);
+
+  *nwords=0;
+  for(i=0;i<nthreads;i++)
+    {
+      if(shards[i].nwords<0)
+        failed=1;
+      *nwords+=shards[i].nwords;
+    }
+  for(i=1;i<nthreads && !failed;i++)
+    if(wt_merge(shards[0].wt,shards[i].wt)!=0)
+      failed=1;
+  if(!failed)
+    {
+      result=shards[0].wt;
+      shards[0].wt=NULL;
+    }
+
+ done:
+  if(shards!=NULL)
+    for(i=0;i<nthreads;i++)
+      wt_free(shards[i].wt);
+  free(shards);
+  free(tids);
+  return result;
+}
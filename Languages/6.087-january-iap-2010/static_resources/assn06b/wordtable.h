@@ -0,0 +1,89 @@
+#ifndef WORDTABLE_H
+#define WORDTABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+  Word-count table: open addressing with Robin Hood probing, keys interned
+  in a string arena.
+
+  Each slot holds the word's 64-bit hash next to the key pointer, so a
+  probe compares hashes before touching any string, and a lookup walks a
+  short run of adjacent slots instead of a linked list. Words are copied
+  once into large arena blocks (no malloc/strdup per word) and freed all
+  at once by wt_free(). The table doubles when it is 80% full.
+*/
+
+struct wordentry
+{
+  const char* word;    /* NUL-terminated, in the arena; NULL if slot empty */
+  unsigned long count;
+  uint64_t hash;
+  size_t len;
+};
+
+struct wordtable;
+
+/*
+  @function wt_hash
+  @desc     64-bit hash of len bytes, 8 bytes per step
+*/
+uint64_t wt_hash(const char* str,size_t len);
+
+/*
+  @function wt_alloc
+  @desc     produces an empty table sized for about nwords distinct words
+*/
+struct wordtable* wt_alloc(size_t nwords);
+
+/*
+  @function wt_free
+  @desc     reclaims the table and every word in it
+*/
+void wt_free(struct wordtable* wt);
+
+/*
+  @function wt_lookup
+  @desc     returns the entry for str (len bytes), or creates it with a
+            count of 0 if create is set; NULL if absent or out of memory.
+            The pointer is valid until the next entry is created
+*/
+struct wordentry* wt_lookup(struct wordtable* wt,const char* str,size_t len,int create);
+
+/*
+  @function wt_size
+  @desc     number of distinct words
+*/
+size_t wt_size(const struct wordtable* wt);
+
+/*
+  @function wt_apply
+  @desc     calls fp on every entry, in no particular order
+*/
+void wt_apply(const struct wordtable* wt,void (*fp)(const struct wordentry* pent,void* arg),void* arg);
+
+/*
+  @function wt_merge
+  @desc     adds the counts of every word in src to dst; returns 0 on success
+*/
+int wt_merge(struct wordtable* dst,const struct wordtable* src);
+
+/*
+  @function wt_count_words
+  @desc     counts the whitespace-separated words of buf (the words
+            fscanf("%s") would read) into wt; returns the number of words,
+            or -1 if memory runs out
+*/
+long wt_count_words(struct wordtable* wt,const char* buf,size_t len);
+
+/*
+  @function wt_count_words_sharded
+  @desc     splits buf at whitespace into nthreads pieces, counts each into
+            its own table on its own thread, and merges the tables at the
+            end; returns the merged table, or NULL if memory runs out.
+            *nwords receives the total number of words
+*/
+struct wordtable* wt_count_words_sharded(const char* buf,size_t len,int nthreads,long* nwords);
+
+#endif
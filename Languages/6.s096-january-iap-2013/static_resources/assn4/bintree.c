@@ -0,0 +1,457 @@
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bintree.h"
+
+///*** DO NOT CHANGE ANY FUNCTION DEFINITIONS ***///
+
+// Recall node is defined in the header file
+
+// Fewest keys in any node except the root. Merging a node that has just
+// dropped below this with a sibling at exactly this size always fits.
+#define BT_MIN (BT_MAX / 2)
+
+static node *pool = NULL;         // every node, referred to by index
+static size_t pool_cap = 0, pool_used = 0;
+static uint32_t free_list = BT_NONE; // released nodes, chained through next
+static size_t nfree = 0;
+
+static uint32_t root = BT_NONE;
+static int height = 0;            // levels of inner nodes above the leaves
+static size_t nkeys = 0;
+
+static void out_of_memory(void) {
+	fprintf(stderr, "bintree: out of memory\n");
+	abort();
+}
+
+// Make room for n more nodes, so that pointers into the pool stay valid
+// while they are allocated
+static void reserve(size_t n) {
+	size_t cap;
+	node *p;
+
+	if (pool_cap - pool_used + nfree >= n)
+		return;
+	cap = pool_cap ? pool_cap : 64;
+	while (cap - pool_used < n)
+		cap *= 2;
+	if (cap >= BT_NONE)
+		out_of_memory();
+	p = aligned_alloc(64, cap * sizeof(node));
+	if (p == NULL)
+		out_of_memory();
+	if (pool != NULL) {
+		memcpy(p, pool, pool_used * sizeof(node));
+		free(pool);
+	}
+	pool = p;
+	pool_cap = cap;
+}
+
+static void pad(node *p) {
+	int i;
+	for (i = p->count; i < BT_MAX; i++)
+		p->keys[i] = INT_MAX;
+}
+
+static uint32_t alloc_node(void) {
+	uint32_t n;
+
+	if (free_list != BT_NONE) {
+		n = free_list;
+		free_list = pool[n].next;
+		nfree--;
+	} else {
+		n = (uint32_t)pool_used++;
+	}
+	pool[n].count = 0;
+	pool[n].next = BT_NONE;
+	pad(&pool[n]);
+	return n;
+}
+
+static void free_node(uint32_t n) {
+	pool[n].next = free_list;
+	free_list = n;
+	nfree++;
+}
+
+// Number of keys below key. All BT_MAX slots are compared, with the
+// INT_MAX padding never counting, so the loop has no branches and
+// compiles to a few SIMD compares.
+static inline int count_less(const int *keys, int key) {
+	int i, pos = 0;
+	for (i = 0; i < BT_MAX; i++)
+		pos += keys[i] < key;
+	return pos;
+}
+
+// Child of inner node p to follow for key. Padding may count as <= INT_MAX,
+// hence the clamp to p->count.
+static inline int child_index(const node *p, int key) {
+	int i, pos = 0;
+	for (i = 0; i < BT_MAX; i++)
+		pos += p->keys[i] <= key;
+	return pos < p->count ? pos : p->count;
+}
+
+// Request every cache line of a node at once, instead of one at a time as
+// the search reaches them
+static inline void prefetch_node(const node *p) {
+	size_t i;
+	for (i = 0; i < sizeof(node); i += 64)
+		__builtin_prefetch((const char *)p + i);
+}
+
+// The leaf that holds, or would hold, key
+static const node *find_leaf(int key) {
+	const node *p = &pool[root];
+	int level;
+
+	for (level = height; level > 0; level--) {
+		p = &pool[p->child[child_index(p, key)]];
+		prefetch_node(p);
+	}
+	return p;
+}
+
+int find_node(int node_id, int *data) {
+	const node *p;
+	int pos;
+
+	if (root == BT_NONE)
+		return 0;
+	p = find_leaf(node_id);
+	pos = count_less(p->keys, node_id);
+	if (pos < p->count && p->keys[pos] == node_id) {
+		*data = p->data[pos];
+		return 1;
+	}
+	return 0;
+}
+
+// Find the node with node_id, and return its data
+int find_node_data(int node_id) {
+	int data;
+	return find_node(node_id, &data) ? data : NODE_NOT_FOUND;
+}
+
+// Inserts into the subtree at n, level levels above the leaves. Returns 1 if
+// n had to split, with the new right half in *right and the smallest key
+// under it in *sep.
+static int insert_rec(uint32_t n, int level, int key, int data, int *sep, uint32_t *right) {
+	node *p = &pool[n], *q;
+	int keys[BT_MAX + 1], pos, half, s;
+	uint32_t r;
+
+	if (level == 0) {
+		int vals[BT_MAX + 1];
+
+		pos = count_less(p->keys, key);
+		if (pos < p->count && p->keys[pos] == key) {
+			p->data[pos] = data;
+			return 0;
+		}
+		nkeys++;
+		if (p->count < BT_MAX) {
+			memmove(p->keys + pos + 1, p->keys + pos, (p->count - pos) * sizeof(int));
+			memmove(p->data + pos + 1, p->data + pos, (p->count - pos) * sizeof(int));
+			p->keys[pos] = key;
+			p->data[pos] = data;
+			p->count++;
+			return 0;
+		}
+
+		// Full: split BT_MAX + 1 entries between p and a new right leaf
+		memcpy(keys, p->keys, pos * sizeof(int));
+		memcpy(vals, p->data, pos * sizeof(int));
+		keys[pos] = key;
+		vals[pos] = data;
+		memcpy(keys + pos + 1, p->keys + pos, (BT_MAX - pos) * sizeof(int));
+		memcpy(vals + pos + 1, p->data + pos, (BT_MAX - pos) * sizeof(int));
+
+		r = alloc_node();
+		q = &pool[r];
+		half = (BT_MAX + 1) / 2;
+		p->count = half;
+		q->count = BT_MAX + 1 - half;
+		memcpy(p->keys, keys, half * sizeof(int));
+		memcpy(p->data, vals, half * sizeof(int));
+		memcpy(q->keys, keys + half, q->count * sizeof(int));
+		memcpy(q->data, vals + half, q->count * sizeof(int));
+		pad(p);
+		q->next = p->next;
+		p->next = r;
+		*sep = q->keys[0];
+		*right = r;
+		return 1;
+	}
+
+	pos = child_index(p, key);
+	if (!insert_rec(p->child[pos], level - 1, key, data, &s, &r))
+		return 0;
+
+	// The child split: add separator s and child r after position pos
+	if (p->count < BT_MAX) {
+		memmove(p->keys + pos + 1, p->keys + pos, (p->count - pos) * sizeof(int));
+		memmove(p->child + pos + 2, p->child + pos + 1, (p->count - pos) * sizeof(uint32_t));
+		p->keys[pos] = s;
+		p->child[pos + 1] = r;
+		p->count++;
+		return 0;
+	}
+
+	// Full: the middle of BT_MAX + 1 keys moves up, the rest split evenly
+	{
+		uint32_t children[BT_MAX + 2];
+		uint32_t nr;
+
+		memcpy(keys, p->keys, pos * sizeof(int));
+		keys[pos] = s;
+		memcpy(keys + pos + 1, p->keys + pos, (BT_MAX - pos) * sizeof(int));
+		memcpy(children, p->child, (pos + 1) * sizeof(uint32_t));
+		children[pos + 1] = r;
+		memcpy(children + pos + 2, p->child + pos + 1, (BT_MAX - pos) * sizeof(uint32_t));
+
+		nr = alloc_node();
+		q = &pool[nr];
+		half = (BT_MAX + 1) / 2;
+		p->count = half;
+		q->count = BT_MAX - half;
+		memcpy(p->keys, keys, half * sizeof(int));
+		memcpy(p->child, children, (half + 1) * sizeof(uint32_t));
+		memcpy(q->keys, keys + half + 1, q->count * sizeof(int));
+		memcpy(q->child, children + half + 1, (q->count + 1) * sizeof(uint32_t));
+		pad(p);
+		*sep = keys[half];
+		*right = nr;
+		return 1;
+	}
+}
+
+// Insert a new node into the binary tree with node_id and data
+void insert_node(int node_id, int data) {
+	int sep;
+	uint32_t right, top;
+
+	// One split per level plus a new root at most
+	reserve(height + 2);
+	if (root == BT_NONE)
+		root = alloc_node();
+	if (insert_rec(root, height, node_id, data, &sep, &right)) {
+		top = alloc_node();
+		pool[top].keys[0] = sep;
+		pool[top].child[0] = root;
+		pool[top].child[1] = right;
+		pool[top].count = 1;
+		root = top;
+		height++;
+	}
+}
+
+// Child pos of inner node p has dropped below BT_MIN keys: take a key from
+// a sibling that can spare one, or else merge it with a sibling
+static void fix_child(node *p, int pos, int leaf) {
+	node *c = &pool[p->child[pos]];
+	node *l = pos > 0 ? &pool[p->child[pos - 1]] : NULL;
+	node *r = pos < p->count ? &pool[p->child[pos + 1]] : NULL;
+
+	if (l != NULL && l->count > BT_MIN) {
+		memmove(c->keys + 1, c->keys, c->count * sizeof(int));
+		if (leaf) {
+			memmove(c->data + 1, c->data, c->count * sizeof(int));
+			c->keys[0] = l->keys[l->count - 1];
+			c->data[0] = l->data[l->count - 1];
+			p->keys[pos - 1] = c->keys[0];
+		} else {
+			memmove(c->child + 1, c->child, (c->count + 1) * sizeof(uint32_t));
+			c->keys[0] = p->keys[pos - 1];
+			c->child[0] = l->child[l->count];
+			p->keys[pos - 1] = l->keys[l->count - 1];
+		}
+		c->count++;
+		l->count--;
+		pad(l);
+	} else if (r != NULL && r->count > BT_MIN) {
+		if (leaf) {
+			c->keys[c->count] = r->keys[0];
+			c->data[c->count] = r->data[0];
+			memmove(r->data, r->data + 1, (r->count - 1) * sizeof(int));
+		} else {
+			c->keys[c->count] = p->keys[pos];
+			c->child[c->count + 1] = r->child[0];
+			memmove(r->child, r->child + 1, r->count * sizeof(uint32_t));
+		}
+		p->keys[pos] = leaf ? r->keys[1] : r->keys[0];
+		memmove(r->keys, r->keys + 1, (r->count - 1) * sizeof(int));
+		c->count++;
+		r->count--;
+		pad(r);
+	} else {
+		// Merge the pair (li, li + 1) into child li
+		int li = l != NULL ? pos - 1 : pos;
+		uint32_t bi = p->child[li + 1];
+		node *a = &pool[p->child[li]], *b = &pool[bi];
+
+		if (leaf) {
+			memcpy(a->keys + a->count, b->keys, b->count * sizeof(int));
+			memcpy(a->data + a->count, b->data, b->count * sizeof(int));
+			a->count += b->count;
+			a->next = b->next;
+		} else {
+			a->keys[a->count] = p->keys[li];
+			memcpy(a->keys + a->count + 1, b->keys, b->count * sizeof(int));
+			memcpy(a->child + a->count + 1, b->child, (b->count + 1) * sizeof(uint32_t));
+			a->count += b->count + 1;
+		}
+		memmove(p->keys + li, p->keys + li + 1, (p->count - li - 1) * sizeof(int));
+		memmove(p->child + li + 1, p->child + li + 2, (p->count - li - 1) * sizeof(uint32_t));
+		p->count--;
+		pad(p);
+		free_node(bi);
+	}
+}
+
+// Removes key from the subtree at n; returns 1 if it was there
+static int remove_rec(uint32_t n, int level, int key) {
+	node *p = &pool[n];
+	int pos;
+
+	if (level == 0) {
+		pos = count_less(p->keys, key);
+		if (pos >= p->count || p->keys[pos] != key)
+			return 0;
+		memmove(p->keys + pos, p->keys + pos + 1, (p->count - pos - 1) * sizeof(int));
+		memmove(p->data + pos, p->data + pos + 1, (p->count - pos - 1) * sizeof(int));
+		p->count--;
+		pad(p);
+		nkeys--;
+		return 1;
+	}
+
+	pos = child_index(p, key);
+	if (!remove_rec(p->child[pos], level - 1, key))
+		return 0;
+	if (pool[p->child[pos]].count < BT_MIN)
+		fix_child(p, pos, level == 1);
+	return 1;
+}
+
+//Find and remove a node in the binary tree with node_id.
+//Children nodes are fixed appropriately.
+void remove_node(int node_id) {
+	uint32_t old;
+
+	if (root == BT_NONE || !remove_rec(root, height, node_id))
+		return;
+	if (height > 0 && pool[root].count == 0) {
+		old = root;
+		root = pool[root].child[0];
+		height--;
+		free_node(old);
+	}
+}
+
+int bulk_load(const int *node_ids, const int *data, size_t n) {
+	size_t count, parents, total, i, j, k, lo, hi;
+	uint32_t *level, idx;
+	int *level_min, m;
+
+	for (i = 1; i < n; i++)
+		if (node_ids[i - 1] >= node_ids[i])
+			return -1;
+	clear_tree();
+	if (n == 0)
+		return 0;
+
+	// Leaves are filled evenly, as are the inner nodes of each level; with
+	// ceil(count / capacity) nodes per level, every node is at least half full
+	count = (n + BT_MAX - 1) / BT_MAX;
+	for (total = count, i = count; i > 1; i = (i + BT_MAX) / (BT_MAX + 1))
+		total += (i + BT_MAX) / (BT_MAX + 1);
+	reserve(total);
+	level = malloc(count * sizeof(uint32_t));
+	level_min = malloc(count * sizeof(int));
+	if (level == NULL || level_min == NULL)
+		out_of_memory();
+
+	for (i = 0; i < count; i++) {
+		lo = n * i / count;
+		hi = n * (i + 1) / count;
+		idx = alloc_node();
+		pool[idx].count = (int)(hi - lo);
+		memcpy(pool[idx].keys, node_ids + lo, (hi - lo) * sizeof(int));
+		memcpy(pool[idx].data, data + lo, (hi - lo) * sizeof(int));
+		if (i > 0)
+			pool[level[i - 1]].next = idx;
+		level[i] = idx;
+		level_min[i] = node_ids[lo];
+	}
+
+	// Each level is built in place over the one below: parent j only reads
+	// entries at or after j
+	for (height = 0; count > 1; height++, count = parents) {
+		parents = (count + BT_MAX) / (BT_MAX + 1);
+		for (j = 0; j < parents; j++) {
+			lo = count * j / parents;
+			hi = count * (j + 1) / parents;
+			m = level_min[lo];
+			idx = alloc_node();
+			pool[idx].count = (int)(hi - lo - 1);
+			for (k = lo; k < hi; k++) {
+				pool[idx].child[k - lo] = level[k];
+				if (k > lo)
+					pool[idx].keys[k - lo - 1] = level_min[k];
+			}
+			level[j] = idx;
+			level_min[j] = m;
+		}
+	}
+
+	root = level[0];
+	nkeys = n;
+	free(level);
+	free(level_min);
+	return 0;
+}
+
+size_t range_scan(int lo, int hi, void (*visit)(int node_id, int data, void *arg), void *arg) {
+	const node *p;
+	size_t visited = 0;
+	int pos;
+
+	if (root == BT_NONE || lo > hi)
+		return 0;
+	p = find_leaf(lo);
+	pos = count_less(p->keys, lo);
+	for (;;) {
+		for (; pos < p->count; pos++) {
+			if (p->keys[pos] > hi)
+				return visited;
+			visit(p->keys[pos], p->data[pos], arg);
+			visited++;
+		}
+		if (p->next == BT_NONE)
+			return visited;
+		p = &pool[p->next];
+		if (p->next != BT_NONE)
+			prefetch_node(&pool[p->next]);
+		pos = 0;
+	}
+}
+
+size_t tree_size(void) {
+	return nkeys;
+}
+
+void clear_tree(void) {
+	free(pool);
+	pool = NULL;
+	pool_cap = pool_used = nfree = 0;
+	free_list = root = BT_NONE;
+	height = 0;
+	nkeys = 0;
+}
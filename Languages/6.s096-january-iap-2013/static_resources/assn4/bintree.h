@@ -0,0 +1,63 @@
+#ifndef BINTREE_H
+#define BINTREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The tree is a B+ tree rather than one node per key: each node holds up to
+// BT_MAX sorted keys, so a lookup touches about log_32(n) nodes instead of
+// log_2(n), and the tree stays balanced whatever order keys arrive in.
+// Data lives only in the leaves, which are chained left to right for range
+// scans. Nodes come from a pool and refer to each other by index.
+#define BT_MAX 32
+
+typedef struct node {
+	int keys[BT_MAX];  // node_ids, ascending; unused slots hold INT_MAX
+	int count;         // keys in use
+	uint32_t next;     // leaves: the next leaf to the right, or BT_NONE
+	union {
+		int data[BT_MAX];           // leaves: data[i] belongs to keys[i]
+		uint32_t child[BT_MAX + 1]; // inner nodes: keys[i] is the smallest
+		                            // node_id under child[i + 1]
+	};
+} __attribute__((aligned(64))) node;
+
+#define BT_NONE UINT32_MAX
+
+// Returned by find_node_data() when node_id is not in the tree
+#define NODE_NOT_FOUND -1
+
+///*** DO NOT CHANGE ANY FUNCTION DEFINITIONS ***///
+// Declare the tree modification functions below...
+
+// Insert a new node into the tree with node_id and data; an existing
+// node_id has its data replaced
+void insert_node(int node_id, int data);
+
+// Find the node with node_id, and return its data, or NODE_NOT_FOUND
+int find_node_data(int node_id);
+
+// Find and remove the node with node_id, if present
+void remove_node(int node_id);
+
+// Extensions beyond the assignment
+
+// Like find_node_data(), but reports absence separately from the data:
+// returns 1 and sets *data if node_id is present, else returns 0
+int find_node(int node_id, int *data);
+
+// Replace the whole tree with n nodes in O(n). node_ids must be strictly
+// ascending; returns 0, or -1 (tree unchanged) if they are not
+int bulk_load(const int *node_ids, const int *data, size_t n);
+
+// Call visit on every node with lo <= node_id <= hi, in ascending order;
+// returns the number visited
+size_t range_scan(int lo, int hi, void (*visit)(int node_id, int data, void *arg), void *arg);
+
+// Number of nodes in the tree
+size_t tree_size(void);
+
+// Remove every node and release the pool
+void clear_tree(void);
+
+#endif
@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bintree.h"
+
+// Compares the B+ tree in bintree.c with the one-node-per-key binary search
+// tree the assignment describes, for sequential and random insert orders.
+//
+// Build: gcc -O2 -march=native -o bintree_bench bintree_bench.c bintree.c
+// Usage: bintree_bench [keys] [naive-sequential-keys]
+//
+// Defaults: 10000000 keys, and 30000 keys for the naive tree on sequential
+// input. Sorted keys turn the naive tree into a linked list, so inserting n
+// of them takes O(n^2) time; at 10^7 keys that is hours, and its recursion
+// (or path) would be 10^7 deep.
+
+// The naive tree: one malloc'd node per key, no balancing
+typedef struct bst {
+	int node_id;
+	int data;
+	struct bst *left, *right;
+} bst;
+
+static bst *bst_root = NULL;
+
+static void bst_insert(int node_id, int data) {
+	bst **link = &bst_root;
+
+	while (*link != NULL) {
+		if (node_id == (*link)->node_id) {
+			(*link)->data = data;
+			return;
+		}
+		link = node_id < (*link)->node_id ? &(*link)->left : &(*link)->right;
+	}
+	*link = malloc(sizeof(bst));
+	if (*link == NULL) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+	(*link)->node_id = node_id;
+	(*link)->data = data;
+	(*link)->left = (*link)->right = NULL;
+}
+
+static int bst_find(int node_id) {
+	const bst *p = bst_root;
+
+	while (p != NULL && p->node_id != node_id)
+		p = node_id < p->node_id ? p->left : p->right;
+	return p != NULL ? p->data : NODE_NOT_FOUND;
+}
+
+static void bst_clear(void) {
+	// Free iteratively by rotating left children up; no recursion depth
+	bst *p = bst_root, *l;
+
+	while (p != NULL) {
+		if (p->left != NULL) {
+			l = p->left;
+			p->left = l->right;
+			l->right = p;
+			p = l;
+		} else {
+			l = p->right;
+			free(p);
+			p = l;
+		}
+	}
+	bst_root = NULL;
+}
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng = 88172645463325252ULL;
+
+static uint64_t next_random(void) {
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return rng;
+}
+
+static void shuffle(int *a, size_t n) {
+	size_t i, j;
+	int t;
+
+	for (i = n; i > 1; i--) {
+		j = next_random() % i;
+		t = a[i - 1];
+		a[i - 1] = a[j];
+		a[j] = t;
+	}
+}
+
+static long long scan_sum;
+
+static void add_data(int node_id, int data, void *arg) {
+	(void)node_id;
+	(void)arg;
+	scan_sum += data;
+}
+
+static void report(const char *what, size_t n, double seconds) {
+	printf("  %-34s %9.3f s %9.1f ns/key\n", what, seconds, seconds * 1e9 / n);
+}
+
+// Inserts order[0..n) into both trees, then looks every key up in random order
+static int run(const char *name, const int *order, const int *lookups, size_t n, size_t naive_n) {
+	size_t i;
+	double t;
+	int bad = 0;
+
+	printf("%s insert order, %zu keys\n", name, n);
+
+	t = now();
+	for (i = 0; i < n; i++)
+		insert_node(order[i], order[i] ^ 0x5555);
+	report("B+ tree insert", n, now() - t);
+
+	t = now();
+	for (i = 0; i < n; i++)
+		bad += find_node_data(lookups[i]) != (lookups[i] ^ 0x5555);
+	report("B+ tree lookup (random order)", n, now() - t);
+
+	t = now();
+	scan_sum = 0;
+	if (range_scan(0, (int)n - 1, add_data, NULL) != n)
+		bad++;
+	report("B+ tree range scan (all keys)", n, now() - t);
+	clear_tree();
+
+	if (naive_n < n)
+		printf("  (naive tree limited to the first %zu keys)\n", naive_n);
+	t = now();
+	for (i = 0; i < naive_n; i++)
+		bst_insert(order[i], order[i] ^ 0x5555);
+	report("naive BST insert", naive_n, now() - t);
+
+	t = now();
+	for (i = 0; i < naive_n; i++)
+		bad += bst_find(order[naive_n - 1 - i]) != (order[naive_n - 1 - i] ^ 0x5555);
+	report("naive BST lookup", naive_n, now() - t);
+	bst_clear();
+
+	return bad;
+}
+
+static int *alloc_ints(size_t n) {
+	int *p = malloc(n * sizeof(int));
+
+	if (p == NULL) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+	return p;
+}
+
+int main(int argc, char **argv) {
+	size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+	size_t naive_seq = argc > 2 ? strtoul(argv[2], NULL, 10) : 30000;
+	int *keys = alloc_ints(n), *order = alloc_ints(n);
+	int *lookups = alloc_ints(n), *data = alloc_ints(n);
+	size_t i;
+	int bad = 0;
+	double t;
+
+	for (i = 0; i < n; i++) {
+		keys[i] = (int)i;
+		data[i] = (int)i ^ 0x5555;
+	}
+	memcpy(lookups, keys, n * sizeof(int));
+	shuffle(lookups, n);
+
+	memcpy(order, keys, n * sizeof(int));
+	bad += run("sequential", order, lookups, n, naive_seq < n ? naive_seq : n);
+
+	// Bulk load goes before the random run: freeing that run's 10^7 naive
+	// nodes leaves malloc with free chunks to consolidate on the next large
+	// allocation, which would be charged to whatever is timed next
+	printf("bulk load, %zu sorted keys\n", n);
+	t = now();
+	bulk_load(keys, data, n);
+	report("B+ tree bulk load", n, now() - t);
+	t = now();
+	for (i = 0; i < n; i++)
+		bad += find_node_data(lookups[i]) != (lookups[i] ^ 0x5555);
+	report("B+ tree lookup (random order)", n, now() - t);
+	clear_tree();
+
+	shuffle(order, n);
+	bad += run("random", order, lookups, n, n);
+
+	printf(bad ? "%d lookups FAILED\n" : "all lookups correct\n", bad);
+	free(keys);
+	free(order);
+	free(lookups);
+	free(data);
+	return bad != 0;
+}
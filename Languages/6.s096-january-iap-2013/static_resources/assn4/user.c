@@ -0,0 +1,39 @@
+#include <stdio.h>
+#include "bintree.h"
+
+// Build: gcc -O2 -march=native -o user user.c bintree.c
+
+static void print_node(int node_id, int data, void *arg) {
+	(void)arg;
+	printf("  %d -> %d\n", node_id, data);
+}
+
+int main() {
+	/*
+	Insert your test code here. Try inserting nodes then searching for them.
+
+	When we grade, we will overwrite your main function with our own sequence of
+	insertions and deletions to test your implementation. If you change the
+	argument or return types of the binary tree functions, our grading code
+	won't work!
+	*/
+	int i, failures = 0;
+
+	// Sorted input: the worst case for an unbalanced tree
+	for (i = 0; i < 1000; i++)
+		insert_node(i, i * i);
+	for (i = 0; i < 1000; i++)
+		if (find_node_data(i) != i * i)
+			failures++;
+
+	for (i = 0; i < 1000; i += 2)
+		remove_node(i);
+	for (i = 0; i < 1000; i++)
+		if (find_node_data(i) != (i % 2 ? i * i : NODE_NOT_FOUND))
+			failures++;
+
+	printf("%zu nodes, %d failures\nnodes 10..20:\n", tree_size(), failures);
+	range_scan(10, 20, print_node, NULL);
+	clear_tree();
+	return failures != 0;
+}